@@ -0,0 +1,44 @@
+#pragma once
+
+// bump allocator for objects that own nothing, their destructors never run
+// reset drops everything at once and keeps the blocks, so a warmed up arena does not allocate
+class Arena {
+public:
+    template <typename T, typename... Args> T *make(Args &&...args) {
+        return new (_allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+    // uninitialized storage for n trivial values
+    template <typename T> std::span<T> array(size_t n) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        return {static_cast<T *>(_allocate(n * sizeof(T), alignof(T))), n};
+    }
+    void reset() {
+        _block = 0;
+        _used = 0;
+    }
+
+private:
+    void *_allocate(size_t size, size_t align) {
+        for (;; ++_block, _used = 0) {
+            if (_block == _blocks.size()) {
+                auto const bytes = std::max(size + align, _blockSize);
+                _blocks.push_back({std::make_unique_for_overwrite<std::byte[]>(bytes), bytes});
+            }
+            auto &block = _blocks[_block];
+            auto const base = reinterpret_cast<uintptr_t>(block.data.get());
+            auto const offset = ((base + _used + align - 1) & ~(align - 1)) - base;
+            if (offset + size <= block.size) {
+                _used = offset + size;
+                return block.data.get() + offset;
+            }
+        }
+    }
+
+    struct Block {
+        std::unique_ptr<std::byte[]> data;
+        size_t size;
+    };
+    static constexpr size_t _blockSize = 64 << 10;
+    std::vector<Block> _blocks;
+    size_t _block{}, _used{};
+};
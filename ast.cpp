@@ -0,0 +1,168 @@
+#include "ast.h"
+
+node::Ref reduceAst(node::Ast &ast, Kind kind, std::span<Parser::Value> args) {
+    // terminals naming sets become leaves, nonterminals were built when they were reduced
+    auto get = [&](size_t idx) -> node::Ref {
+        auto &arg = args[idx];
+        if (arg.ast) return arg.ast;
+        switch (arg.kind.value()) {
+        case Kind::Id: return ast.set(arg.view);
+        case Kind::Bool: return ast.boolean(arg.view);
+        case Kind::Number: return ast.number(arg.view);
+        default: return {};
+        }
+    };
+    auto token = [&args](size_t idx) { return node::Token(args[idx].kind, args[idx].view); };
+
+    switch (kind.value()) {
+
+    case Kind::Root: return get(0);
+
+    case Kind::Stmt: {
+        if (auto stmt = get(1)) {
+            ast.pushFront(stmt, get(0));
+            return stmt;
+        }
+        return ast.list(get(0));
+    }
+
+    case Kind::Stm_: {
+        if (args[0].kind == Kind::epsilon) return {};
+        if (auto stmt = get(2)) {
+            ast.pushFront(stmt, get(1));
+            return stmt;
+        }
+        return ast.list(get(1));
+    }
+
+    case Kind::Fact:
+        switch (args[0].kind.value()) {
+        case Kind::Id: {
+            auto lvalue = get(0);
+            if (auto annot = get(1)) {
+                ast.setSuperset(lvalue, annot);
+            }
+            return ast.fact(lvalue, get(2));
+        }
+        case Kind::Module: return ast.module(get(3), args[1].view, token(0).combine(token(4)).view);
+        default: return {};
+        }
+
+    case Kind::Fac_: return args[0].kind == Kind::epsilon ? node::Ref{} : get(1);
+
+    case Kind::Exp1:
+        switch (args[0].kind.value()) {
+        case Kind::RtoL: {
+            auto lexp = get(0);
+            ast.setOperand(lexp, get(1));
+            return lexp;
+        }
+        case Kind::Id: {
+            auto id = get(0);
+            auto params = get(1);
+            auto super = get(2);
+            ast.setParams(id, params);
+            return ast.expression(id, super);
+        }
+        case Kind::OpenParenthesis: return get(1);
+        case Kind::OpenCurlyBracket: return ast.empty(token(0).combine(token(1)).view);
+        default: return get(0);
+        }
+
+    case Kind::Exp2:
+    case Kind::Exp3:
+    case Kind::Exp4:
+    case Kind::Exp5:
+    case Kind::Exp6: {
+        auto l = get(0);
+        auto r = get(1);
+        if (r) {
+            ast.setLhs(r, l);
+            return r;
+        }
+        return l;
+    }
+
+    case Kind::Exp2_:
+    case Kind::Exp3_:
+    case Kind::Exp4_:
+    case Kind::Exp5_:
+    case Kind::Exp6_: {
+        if (args[0].kind == Kind::epsilon) return {};
+        auto left = get(0);
+        auto expr = get(1);
+        auto right = get(2);
+        if (!right) {
+            ast.setRhs(left, expr);
+            return left;
+        }
+        ast.setRhs(left, expr);
+        ast.setLhs(right, left);
+        return right;
+    }
+
+    case Kind::Binary: { // an operator chain parsed by precedence, already associated
+        auto binary = ast.binary(args[1].kind, args[1].view);
+        ast.setLhs(binary, get(0));
+        ast.setRhs(binary, get(2));
+        return binary;
+    }
+
+    case Kind::RtoL: return ast.unary(args[0].kind, args[0].view);
+
+    case Kind::Op2:
+    case Kind::Op3:
+    case Kind::Op4:
+    case Kind::Op5:
+    case Kind::Op6: return ast.binary(args[0].kind, args[0].view);
+
+    case Kind::Super:
+        switch (args[0].kind.value()) {
+        case Kind::epsilon: return {};
+        case Kind::SingleColon: {
+            auto extract = get(1);
+            auto params = get(2);
+            auto super = get(3);
+            ast.setParams(extract, params);
+            return ast.expression(extract, super);
+        }
+        }
+
+    case Kind::Params:
+    case Kind::Annot: return args[0].kind == Kind::epsilon ? node::Ref{} : get(1);
+
+    default: return {};
+    }
+}
+
+Parser::Reduce reduceInto(node::Ast &ast) {
+    return [&ast](Kind kind, std::span<Parser::Value> args) { return reduceAst(ast, kind, args); };
+}
+
+node::Ref genAst(node::Ast &ast, node::Nonterm &self) {
+    // post order over explicit stacks, a nonterminal is reduced once the values of all its args are on top
+    struct Frame {
+        node::Nonterm *nonterm;
+        size_t next; // the arg to visit next
+    };
+    std::vector<Frame> stack{{&self, 0}};
+    std::vector<Parser::Value> values;
+    for (;;) {
+        auto &[nonterm, next] = stack.back();
+        if (next < nonterm->args.size()) {
+            auto *arg = nonterm->args[next++];
+            if (auto *child = dynamic_cast<node::Nonterm *>(arg)) {
+                stack.push_back({child, 0});
+            } else {
+                values.push_back({arg->kind, arg->view, {}});
+            }
+            continue;
+        }
+        auto const args = values.end() - static_cast<std::ptrdiff_t>(nonterm->args.size());
+        auto const reduced = reduceAst(ast, nonterm->kind, std::span(args, values.end()));
+        values.erase(args, values.end());
+        stack.pop_back();
+        if (stack.empty()) return reduced;
+        values.push_back({nonterm->kind, nonterm->view, reduced});
+    }
+}
@@ -0,0 +1,9 @@
+#pragma once
+#include "parser.h"
+
+// the ast of one reduction, from the values of the children of kind, its nodes go into ast
+node::Ref reduceAst(node::Ast &ast, Kind kind, std::span<Parser::Value> args);
+// reduces into ast, for Parser::setReduce
+Parser::Reduce reduceInto(node::Ast &ast);
+// the ast of a cst, reduced bottom up like the parser does without one, without recursing however deep the cst is
+node::Ref genAst(node::Ast &ast, node::Nonterm &self);
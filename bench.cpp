@@ -0,0 +1,655 @@
+#include "bench.h"
+#include "ast.h"
+#include "cfg.h"
+#include "descent.h"
+#include "incremental.h"
+#include "lexicon.h"
+#include "outs.h"
+#include "pipeline.h"
+#include "relexer.h"
+#include "tokens.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+namespace {
+
+// whole copies of the source until it reaches size
+std::string repeat(std::string const &source, size_t size) {
+    std::string res;
+    res.reserve(size + source.size() + 1);
+    while (res.size() < size) {
+        res += source;
+        res += '\n';
+    }
+    return res;
+}
+
+// runs f on a thread of its own with a stack of size bytes, whatever the limit of the main one is
+// false if there is no such thread, f did not run then
+bool onStack(size_t size, std::function<void()> f) {
+#ifdef _WIN32
+    auto const start = [](void *arg) -> DWORD {
+        (*static_cast<std::function<void()> *>(arg))();
+        return 0;
+    };
+    auto thread = CreateThread(nullptr, size, start, &f, STACK_SIZE_PARAM_IS_A_RESERVATION, nullptr);
+    if (!thread) return false;
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+#else
+    auto const start = [](void *arg) -> void * {
+        (*static_cast<std::function<void()> *>(arg))();
+        return nullptr;
+    };
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, size);
+    pthread_t thread;
+    auto const err = pthread_create(&thread, &attr, start, &f);
+    pthread_attr_destroy(&attr);
+    if (err != 0) return false;
+    pthread_join(thread, nullptr);
+#endif
+    return true;
+}
+
+template <typename F> double seconds(F &&f) {
+    auto const begin = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+template <typename Tokens> size_t lexAll(std::string const &str, Tokens const &tokens) {
+    Lexer lexer(str);
+    size_t count{};
+    for (auto next = lexer.next(tokens); !lexer.empty(); next = lexer.next(tokens)) {
+        ++count;
+    }
+    return count;
+}
+
+template <typename Tokens> void report(std::string_view name, std::string const &str, Tokens const &tokens) {
+    size_t count{};
+    auto const time = seconds([&] { count = lexAll(str, tokens); });
+    auto const mb = static_cast<double>(str.size()) / (1 << 20);
+    Quiet(), std::format("{:>8}: {:10.2f} MB/s, {} tokens in {:.3f} MB\n", name, mb / time, count, mb);
+}
+
+// the terminals of a cst in order, without the epsilons, counting its nodes on the way
+std::vector<node::Token const *> leaves(node::Token const *root, size_t &nodes) {
+    std::vector<node::Token const *> res, todo{root};
+    while (!todo.empty()) {
+        auto const *t = todo.back();
+        todo.pop_back();
+        ++nodes;
+        if (auto const *nonterm = dynamic_cast<node::Nonterm const *>(t)) {
+            todo.insert(todo.end(), nonterm->args.rbegin(), nonterm->args.rend());
+        } else if (t->kind != Kind::epsilon) {
+            res.push_back(t);
+        }
+    }
+    return res;
+}
+
+std::string dump(node::Ast const &ast, node::Ref root) {
+    std::ostringstream dump;
+    auto *const out = std::cout.rdbuf(dump.rdbuf());
+    ast.dump(root);
+    std::cout.rdbuf(out);
+    return dump.str();
+}
+
+// the ast of a cst as dumped, csts of different shapes agree on it
+std::string dumpAst(node::Token *cst) {
+    node::Ast ast;
+    return dump(ast, genAst(ast, cst->cast<node::Nonterm>()));
+}
+
+} // namespace
+
+void bench::lexer(std::string const &source) {
+    auto const &symbols = LangCFG::getSymbols();
+    token::Dfa const dfa(symbols);
+
+    report("filter", repeat(source, 1 << 20), symbols); // too slow for the full input
+    auto const str = repeat(source, 64 << 20);
+    report("static", str, lexicon::Simpl{});
+    constexpr std::array names{"scalar", "sse2", "avx2"};
+    auto const best = scan::detectIsa();
+    for (auto isa : {scan::Isa::Scalar, scan::Isa::Sse2, scan::Isa::Avx2}) {
+        if (isa > best) break;
+        scan::setIsa(isa);
+        report(names[static_cast<size_t>(isa)], str, dfa);
+    }
+    // with multibyte characters every few bytes, many of them across the blocks of the vectors, and then broken
+    // in one place after the other, every isa has to stop where the scalar one does
+    auto const text = repeat(source + "\n// ünïcødé ✓ 𝄞 ä\n", 64 << 20);
+    std::vector<std::string> broken;
+    std::mt19937 random(1);
+    for (size_t i{}; i < 200; ++i) {
+        auto &str = broken.emplace_back(text.substr(0, 4096));
+        str[random() % str.size()] = static_cast<char>(0x80 + random() % 0x80);
+    }
+    for (auto isa : {scan::Isa::Scalar, scan::Isa::Sse2, scan::Isa::Avx2}) {
+        if (isa > best) break;
+        auto const validate = [](std::string const &str) { return scan::utf8(str.data(), str.data() + str.size()); };
+        size_t differ{};
+        for (auto const &str : broken) {
+            scan::setIsa(scan::Isa::Scalar);
+            auto const *const expect = validate(str);
+            scan::setIsa(isa);
+            differ += validate(str) != expect;
+        }
+        auto const mb = static_cast<double>(str.size()) / (1 << 20);
+        auto const ascii = seconds([&] { (void)validate(str); });
+        char const *end{};
+        auto const multibyte = seconds([&] { end = validate(text); });
+        differ += end != text.data() + text.size();
+        constexpr auto txt = "{:>8}: {:10.2f} MB/s utf-8 validation, {:10.2f} MB/s with multibyte characters{}\n";
+        Quiet(), std::format(txt, names[static_cast<size_t>(isa)], mb / ascii, mb / multibyte,
+                             differ ? ", stops elsewhere than scalar" : "");
+    }
+    scan::setIsa(best);
+}
+
+void bench::parallel(std::string const &source) {
+    token::Dfa const dfa(LangCFG::getSymbols());
+    auto const str = repeat(source, 32 << 20);
+    auto const mb = static_cast<double>(str.size()) / (1 << 20);
+    auto const expect = Lexer::lexAll(str, dfa);
+    auto const most = std::max(std::thread::hardware_concurrency(), 1U);
+    double single{};
+    Quiet(), "lexing\n";
+    for (unsigned jobs = 1; jobs <= most; jobs *= 2) {
+        std::vector<node::Token> tokens;
+        auto const time = seconds([&] { tokens = Lexer::lexAll(str, dfa, jobs); });
+        single = jobs == 1 ? time : single;
+        bool const same = std::ranges::equal(tokens, expect, [](node::Token const &l, node::Token const &r) {
+            return l.kind == r.kind && l.view.data() == r.view.data() && l.view.size() == r.view.size();
+        });
+        constexpr auto txt = "{:>3} threads: {:10.2f} MB/s, x{:.2f}{}\n";
+        Quiet(), std::format(txt, jobs, mb / time, single / time, same ? "" : ", differs from sequential");
+    }
+
+    // the parser is far slower than the lexer
+    auto const wide = repeat(source, 4 << 20);
+    auto const wideMb = static_cast<double>(wide.size()) / (1 << 20);
+    TokenStream const stream(wide, dfa);
+    setVerbosity(Verbosity::Quiet);
+    Parser parser;
+    parser.setupGramma(LangCFG::getCFG());
+    node::Ast ast;
+    parser.setReduce(reduceInto(ast));
+    auto const sequential = seconds([&] {
+        for (uint32_t i = 0; i < stream.size(); ++i) {
+            parser.parse(stream, i);
+        }
+    });
+    auto const expected = dump(ast, parser.getValues().front().ast);
+    parser.restart();
+    Quiet(), std::format("parsing\n sequential: {:10.2f} MB/s\n", wideMb / sequential);
+    for (unsigned jobs = 1; jobs <= most; jobs *= 2) {
+        node::Ast joined;
+        node::Ref parallel;
+        auto const time = seconds([&] { parallel = parseParallel(parser, stream, jobs, joined); });
+        constexpr auto txt = "{:>3} threads: {:10.2f} MB/s, x{:.2f}{}\n";
+        auto const same = parallel && dump(joined, parallel) == expected;
+        Quiet(), std::format(txt, jobs, wideMb / time, sequential / time, same ? "" : ", differs from sequential");
+    }
+}
+
+void bench::parser(std::string const &source) {
+    setVerbosity(Verbosity::Quiet);
+    auto const run = [](std::string_view name, Parser::CFG const &cfg, Kind root, Kind epsilon, std::string const &str,
+                        auto const &tokens) {
+        std::vector<node::Token> lexed;
+        Lexer lexer(str);
+        for (auto next = lexer.next(tokens); !lexer.empty(); next = lexer.next(tokens)) {
+            lexed.push_back(next);
+        }
+        Parser parser;
+        parser.setupGramma(cfg, root, epsilon);
+        int err{};
+        auto const time = seconds([&] {
+            for (auto const &token : lexed) {
+                err += parser.parse(token);
+            }
+        });
+        auto const mb = static_cast<double>(str.size()) / (1 << 20);
+        constexpr auto txt = "{:>6}: {:10.2f} MB/s, {:10.2f} M tokens/s{}\n";
+        Quiet(), std::format(txt, name, mb / time, lexed.size() / time / 1e6, err > 0 ? ", syntax errors" : "");
+    };
+
+    run("simpl", LangCFG::getCFG(), Kind::Root, Kind::epsilon, repeat(source, 4 << 20),
+        token::Dfa(LangCFG::getSymbols()));
+    run("bnf", LangCFG::getBnfCFG(), Kind::GRoot, Kind::GEpsilon, repeat(std::string(Source("simpl.bnf").view()), 4 << 20),
+        lexicon::Bnf{});
+}
+
+void bench::startup() {
+    setVerbosity(Verbosity::Quiet);
+    Parser parser;
+    auto const cold = seconds([&] { parser.setupGramma(LangCFG::getCFG()); });
+    LangCFG::setup(parser); // writes the artifact if it is missing
+    auto const warm = seconds([&] { LangCFG::setup(parser); });
+    Quiet(), std::format("compiled: {:8.3f} ms\n  loaded: {:8.3f} ms\n", cold * 1e3, warm * 1e3);
+}
+
+void bench::frontend(std::string const &source) {
+    setVerbosity(Verbosity::Quiet);
+    token::Dfa const dfa(LangCFG::getSymbols());
+    auto const cfg = LangCFG::getCFG();
+    auto const str = repeat(source, 256 << 10); // the parser is far slower than the lexer
+    auto const mb = static_cast<double>(str.size()) / (1 << 20);
+
+    Parser parser;
+    auto const report = [&](std::string_view name, auto &&front) {
+        parser.setupGramma(cfg);
+        int err{};
+        auto const time = seconds([&] { err = front(); });
+        Quiet(), std::format("{:>10}: {:8.3f} s, {:10.2f} MB/s{}\n", name, time, mb / time, err > 0 ? ", syntax errors" : "");
+    };
+
+    report("lex", [&] { return (void)lexAll(str, dfa), 0; });
+    TokenStream const stream(str, dfa);
+    report("parse", [&] {
+        int err{};
+        for (uint32_t i = 0; i < stream.size(); ++i) {
+            err += parser.parse(stream, i);
+        }
+        return err;
+    });
+    report("parse+ast", [&] {
+        int err{};
+        for (uint32_t i = 0; i < stream.size(); ++i) {
+            err += parser.parse(stream, i);
+        }
+        node::Ast ast;
+        genAst(ast, parser.getCst().front()->cast<node::Nonterm>());
+        parser.restart();
+        return err;
+    });
+    report("descent", [&] { return Descent(stream).parse() ? 0 : 1; });
+    node::Ast direct;
+    parser.setReduce(reduceInto(direct));
+    report("direct", [&] {
+        int err{};
+        for (uint32_t i = 0; i < stream.size(); ++i) {
+            err += parser.parse(stream, i);
+        }
+        parser.restart();
+        return err;
+    });
+    auto const perNode = static_cast<double>(direct.bytes()) / static_cast<double>(std::max<size_t>(direct.nodes(), 1));
+    Quiet(), std::format("{:>10}: {} nodes, {:.1f} bytes each\n", "ast", direct.nodes(), perNode);
+    direct = {};
+    parser.setReduce({});
+    report("lex+parse", [&] {
+        int err{};
+        Lexer lexer(str);
+        for (auto next = lexer.next(dfa); !lexer.empty(); next = lexer.next(dfa)) {
+            err += parser.parse(next);
+        }
+        return err;
+    });
+    report("pipelined", [&] {
+        bool finished{};
+        return parsePipelined(parser, str, dfa, finished);
+    });
+}
+
+void bench::descent(std::string const &source) {
+    setVerbosity(Verbosity::Quiet);
+    token::Dfa const dfa(LangCFG::getSymbols());
+    Parser parser;
+    parser.setupGramma(LangCFG::getCFG());
+
+    // the source itself, and with every token once dropped and once doubled
+    std::vector<std::string> corpus{source};
+    {
+        TokenStream const stream(source, dfa);
+        for (uint32_t i = 0; i + 1 < stream.size(); ++i) {
+            auto const [offset, length] = stream.span(i);
+            corpus.push_back(source.substr(0, offset) + source.substr(offset + length));
+            corpus.push_back(source.substr(0, offset + length) + ' ' + source.substr(offset));
+        }
+    }
+
+    size_t accepted{}, differ{}, tableNodes{}, descentNodes{};
+    double table{}, descent{};
+    auto *const out = std::cout.rdbuf(nullptr); // both report the syntax errors
+    for (auto const &str : corpus) {
+        TokenStream const stream(str, dfa);
+        int err{};
+        table += seconds([&] {
+            for (uint32_t i = 0; i < stream.size(); ++i) {
+                err += parser.parse(stream, i);
+            }
+        });
+        Descent d(stream);
+        node::Token *root{};
+        descent += seconds([&] { root = d.parse(); });
+        if (!root != (err > 0)) {
+            ++differ;
+        } else if (root) {
+            auto const same = [](node::Token const *l, node::Token const *r) {
+                return l->kind == r->kind && l->view.data() == r->view.data() && l->view.size() == r->view.size();
+            };
+            auto *const expect = parser.getCst().front();
+            differ += !std::ranges::equal(leaves(expect, tableNodes), leaves(root, descentNodes), same) ||
+                      dumpAst(expect) != dumpAst(root);
+        }
+        accepted += root != nullptr;
+        parser.restart();
+    }
+    std::cout.rdbuf(out);
+    Quiet(), std::format("{} inputs, {} accepted, {} parsed differently\n", corpus.size(), accepted, differ);
+    Quiet(), std::format("  table: {} cst nodes\ndescent: {} cst nodes\n", tableNodes, descentNodes);
+    Quiet(), std::format("  table: {:8.3f} ms\ndescent: {:8.3f} ms\n", table * 1e3, descent * 1e3);
+}
+
+void bench::stress() {
+    setVerbosity(Verbosity::Quiet);
+    token::Dfa const dfa(LangCFG::getSymbols());
+    Parser parser;
+    parser.setupGramma(LangCFG::getCFG());
+
+    constexpr size_t n = 1'000'000;
+    auto const times = [](size_t count, std::string_view item) {
+        std::string res;
+        res.reserve(count * item.size());
+        for (size_t i{}; i < count; ++i) {
+            res += item;
+        }
+        return res;
+    };
+    std::string facts = "main = f0 + f1";
+    for (size_t i{}; i < n; ++i) {
+        facts += std::format(",\nf{} = {}", i, i);
+    }
+    // a flat list of facts is as deep as it is long in the cst, the rest are deep in the ast as well
+    std::vector<std::pair<std::string_view, std::string>> const inputs{
+        {      "facts",                                                     facts},
+        {  "operators",                                "main = 1" + times(n, " + 1")},
+        {  "negations",                                 "main = " + times(n, "- ") + "1"},
+        {"parentheses", "main = " + times(n / 10, "(") + "1" + times(n / 10, ")")},
+    };
+
+    SourceManager const sources;
+    // each case on a small stack, recursing as deep as the input crashes it instead of depending on a ulimit
+    constexpr size_t stack = 256 << 10;
+    for (auto const &[name, str] : inputs) {
+        auto const ran = onStack(stack, [&] {
+            TokenStream const stream(str, dfa);
+            int err{};
+            node::Ast ast;
+            auto const cst = seconds([&] {
+                for (uint32_t i = 0; i < stream.size(); ++i) {
+                    err += parser.parse(stream, i);
+                }
+                genAst(ast, parser.getCst().front()->cast<node::Nonterm>());
+                parser.restart();
+            });
+            auto const teardown = seconds([&] { ast = {}; });
+            parser.setReduce(reduceInto(ast));
+            node::Ref stmts;
+            auto const direct = seconds([&] {
+                for (uint32_t i = 0; i < stream.size(); ++i) {
+                    err += parser.parse(stream, i);
+                }
+                stmts = err > 0 ? node::Ref{} : parser.getValues().front().ast;
+                parser.restart();
+            });
+            parser.setReduce({});
+            // digested and solved as run does, those walk the ast as deep as it is too
+            std::string solved = "nothing";
+            auto const evaluate = seconds([&] {
+                if (!stmts) return;
+                Context ctx(sources);
+                auto const root = ast.module(stmts, "stress");
+                ctx.scope.push(root.index());
+                auto const expr = ast.expression(ast.set("main"), ast.expression(ast.set("stress"), {}));
+                ast.digest(expr, ctx);
+                ast.digest(root, ctx);
+                ctx.params.push(set::create<set::Sets>());
+                solved = ast.solve(expr, ctx).show();
+            });
+            ast = {};
+            constexpr auto txt = "{:>11}: {:8} tokens, cst and ast {:6.3f} s, direct {:6.3f} s, teardown {:6.3f} s, "
+                                 "digest and solve {:6.3f} s to {}{}\n";
+            Quiet(), std::format(txt, name, stream.size(), cst, direct, teardown, evaluate, solved,
+                                 err > 0 ? ", syntax errors" : "");
+        });
+        if (!ran) {
+            Quiet<style::red>(), "cannot create a thread with a stack of ", stack, " bytes\n";
+            return;
+        }
+    }
+}
+
+void bench::symbols() {
+    constexpr size_t n = 1'000'000;
+    std::vector<std::string> names(n);
+    for (size_t i{}; i < n; ++i) {
+        names[i] = std::format("symbol{}", i);
+    }
+    auto &symbols = Symbols::global();
+    auto const before = symbols.size();
+    auto const jobs = std::max(std::thread::hardware_concurrency(), 4U);
+    // every thread interns all names, starting at a different one, so they race on adding most of them
+    std::vector<std::vector<uint32_t>> ids(jobs, std::vector<uint32_t>(n));
+    auto const adding = seconds([&] {
+        std::vector<std::jthread> threads;
+        for (unsigned t{}; t < jobs; ++t) {
+            threads.emplace_back([&, t] {
+                for (size_t k{}; k < n; ++k) {
+                    auto const i = (k + t * n / jobs) % n;
+                    ids[t][i] = symbols.intern(names[i]);
+                }
+            });
+        }
+    });
+    bool same = symbols.size() - before == n;
+    for (size_t i{}; i < n; ++i) {
+        same = same && symbols.name(ids[0][i]) == names[i] &&
+               std::ranges::all_of(ids, [&](auto const &other) { return other[i] == ids[0][i]; });
+    }
+    auto const finding = seconds([&] {
+        for (size_t i{}; i < n; ++i) {
+            same = same && symbols.intern(names[i]) == ids[0][i];
+        }
+    });
+    constexpr auto txt = "{} names on {} threads: {:.3f} s, looked up again: {:.1f} ns each{}\n";
+    Quiet(), std::format(txt, n, jobs, adding, finding * 1e9 / n, same ? "" : ", ids differ");
+}
+
+void bench::relex(std::string const &source) {
+    setVerbosity(Verbosity::Quiet);
+    token::Dfa const dfa(LangCFG::getSymbols());
+    auto str = repeat(source, 1 << 18);
+    Relexer relexer(dfa, str);
+
+    // the tokens of lexing text whole, as the relexer keeps them
+    auto const lexAll = [&dfa](std::string const &text) {
+        std::vector<Relexer::Token> res;
+        std::vector<std::string_view> rejected;
+        Lexer lexer(text);
+        lexer.collectRejects(&rejected);
+        auto const token = [&text](Kind kind, std::string_view view) {
+            auto const begin = static_cast<uint32_t>(view.data() - text.data());
+            return Relexer::Token{kind, begin, begin + static_cast<uint32_t>(view.size())};
+        };
+        do {
+            auto const next = lexer.next(dfa);
+            for (auto const view : rejected) {
+                res.push_back(token(Kind::Invalid, view));
+            }
+            rejected.clear();
+            res.push_back(token(next.kind, next.view));
+        } while (res.back().kind != Kind::Eof);
+        return res;
+    };
+
+    std::array<std::string_view, 14> const inserts{" ", "a", "7", "1.5", ",", "(", ")", "'", "\"", "/*", "*/", "//",
+                                                   "\n", "module m { x = 1 }"};
+    std::mt19937 random(1);
+    auto expect = lexAll(str);
+    size_t edits{}, differ{}, relexed{};
+    double total{}, longest{}, full{};
+    for (; edits < 2000; ++edits) {
+        auto offset = random() % (str.size() + 1);
+        size_t erase = random() % 3 == 0 ? random() % 8 : 0;
+        auto const insert = erase > 0 && random() % 2 == 0 ? std::string_view{} : inserts[random() % inserts.size()];
+        // the text stays utf-8, no multibyte character is cut
+        auto const cuts = [&str](size_t at) { return at < str.size() && (str[at] & 0xc0) == 0x80; };
+        while (cuts(offset)) {
+            --offset;
+        }
+        erase = std::min(erase, str.size() - offset);
+        while (cuts(offset + erase)) {
+            ++erase;
+        }
+
+        str.replace(offset, erase, insert);
+        Relexer::Change change{};
+        auto const time = seconds([&] { change = relexer.edit(offset, erase, insert); });
+        total += time;
+        longest = std::max(longest, time);
+        relexed += change.inserted;
+
+        std::vector<Relexer::Token> now;
+        full += seconds([&] { now = lexAll(str); });
+        auto const delta = static_cast<int64_t>(insert.size()) - static_cast<int64_t>(erase);
+        // the tokens outside the change are the old ones, those behind it moved by the edit
+        auto const kept = [&](size_t i) {
+            if (i < change.first) return now[i] == expect[i];
+            auto const &t = expect[i - change.inserted + change.removed];
+            return now[i] == Relexer::Token{t.kind, static_cast<uint32_t>(t.begin + delta),
+                                            static_cast<uint32_t>(t.end + delta)};
+        };
+        bool same = relexer.size() == now.size() && relexer.tokens(0, now.size()) == now && relexer.text() == str &&
+                    now.size() + change.removed == expect.size() + change.inserted;
+        for (size_t i{}; same && i < now.size(); ++i) {
+            same = (i >= change.first && i < change.first + change.inserted) || kept(i);
+        }
+        differ += !same;
+        expect = std::move(now);
+    }
+    constexpr auto txt = "{} edits of {:.1f} MB, {} differ from lexing the edited text whole\n"
+                         "  edit: {:8.3f} us on average, {:8.3f} us at most, {:.1f} tokens relexed on average\n"
+                         "  full: {:8.3f} us on average\n";
+    Quiet(), std::format(txt, edits, static_cast<double>(str.size()) / (1 << 20), differ, total / edits * 1e6,
+                         longest * 1e6, static_cast<double>(relexed) / edits, full / edits * 1e6);
+}
+
+void bench::incremental(std::string const &source) {
+    setVerbosity(Verbosity::Quiet);
+    token::Dfa const dfa(LangCFG::getSymbols());
+    Parser parser;
+    parser.setupGramma(LangCFG::getCFG());
+
+    std::string str;
+    for (size_t lines{}; lines < 100'000; lines += std::ranges::count(source, '\n') + 1) {
+        str += source;
+        str += '\n';
+    }
+    Incremental document(parser, dfa);
+    auto const full = seconds([&] { document.parse(str); });
+    auto const blocks = document.trees().size();
+
+    // the errors and the asts kept and reparsed have to be those of lexing and parsing the edited text whole into
+    // one ast, which has none after errors
+    parser.setReporting(false);
+    auto const parseWhole = [&] {
+        std::vector<std::string_view> rejected;
+        Lexer lexer(str);
+        lexer.collectRejects(&rejected);
+        node::Ast ast;
+        parser.setReduce(reduceInto(ast));
+        int err{};
+        for (auto next = lexer.next(dfa); !lexer.empty(); next = lexer.next(dfa)) {
+            err += parser.parse(next);
+            if (next.kind == Kind::Eof) err += !next.view.empty(); // the rest of an unfinished token
+        }
+        err += static_cast<int>(rejected.size());
+        auto const res = std::pair(err, err > 0 ? std::string{} : dump(ast, parser.getValues().front().ast));
+        parser.restart();
+        parser.setReduce({});
+        return res;
+    };
+    bool same = true;
+    auto const check = [&] {
+        std::string dumped;
+        for (auto const &[ast, statements] : document.trees()) {
+            dumped += dump(*ast, statements);
+        }
+        auto const [errors, expected] = parseWhole();
+        same &= document.text() == str && document.errors() == errors && (errors > 0 || dumped == expected);
+    };
+
+    // digits changed and spaces beside spaces put in for good, other spaces and now and then a comma put in
+    // at random and taken out again
+    std::mt19937 random(1);
+    size_t edits{};
+    double total{}, longest{}, fallbacks{};
+    // str is edited first, the document follows
+    auto const edit = [&](size_t offset, size_t length, std::string_view text) {
+        auto const before = document.fallbacks();
+        auto const time = seconds([&] { document.edit(offset, length, text); });
+        if (document.fallbacks() > before) {
+            fallbacks += time;
+            return;
+        }
+        total += time;
+        longest = std::max(longest, time);
+        ++edits;
+    };
+    for (size_t i{}; i < 1000; ++i) {
+        auto const offset = random() % str.size();
+        if (std::isdigit(static_cast<unsigned char>(str[offset]))) {
+            str[offset] = static_cast<char>('0' + (str[offset] - '0' + 1) % 10);
+            edit(offset, 1, std::string_view(str).substr(offset, 1));
+            continue;
+        }
+        auto const kept = std::isspace(static_cast<unsigned char>(str[offset])) && i % 100 != 0;
+        str.insert(offset, 1, i % 100 == 0 ? ',' : ' ');
+        edit(offset, 0, std::string_view(str).substr(offset, 1));
+        if (kept) continue; // beside other space, it changes nothing but where the rest of the text is
+        if (i % 250 == 0) check(); // with syntax errors in it most likely
+        str.erase(offset, 1);
+        edit(offset, 1, {});
+    }
+    check();
+
+    // a fact put in right after a top-level comma or at the end, which the random edits may never hit, is one
+    // more top-level comma, the document is parsed whole for it and for taking it out again
+    for (size_t i{}; i < 8; ++i) {
+        TokenStream const stream(str, dfa);
+        std::vector<size_t> after;
+        auto const kind = [&stream](size_t k) { return stream.kind(static_cast<uint32_t>(k)); };
+        topLevelCommas(stream.size(), kind, [&](size_t k) {
+            after.push_back(stream.span(static_cast<uint32_t>(k)).offset + 1);
+        });
+        auto const offset = i % 2 == 0 && !after.empty() ? after[random() % after.size()] : str.size();
+        std::string_view const fact = "\ninserted = 1,";
+        str.insert(offset, fact);
+        edit(offset, 0, fact);
+        check();
+        str.erase(offset, fact.size());
+        edit(offset, fact.size(), {});
+    }
+    check();
+
+    auto const lines = std::ranges::count(str, '\n');
+    auto const whole = document.fallbacks();
+    Quiet(), std::format("full parse: {:8.3f} ms, {} lines, {} facts and modules\n", full * 1e3, lines, blocks);
+    constexpr auto txt = "     edits: {:8.3f} us on average, {:8.3f} us at most, over {} edits\n"
+                         "            {:8.3f} ms on average for the {} moving a top-level comma, parsed whole{}\n";
+    Quiet(), std::format(txt, total / edits * 1e6, longest * 1e6, edits, whole ? fallbacks / whole * 1e3 : 0., whole,
+                         same ? "" : ", differs from parsing the edited text");
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+namespace bench {
+
+// throughput of the filtering and the compile-time lexers, and of the dfa lexer and the utf-8 validation
+// on every supported isa
+void lexer(std::string const &source);
+// scaling of the chunked lexer and of parsing the top-level facts from one thread up to the hardware concurrency
+void parallel(std::string const &source);
+// parsing pre-lexed tokens, the source with the simpl grammar and simpl.bnf with the grammar of bnf
+void parser(std::string const &source);
+// setting the parser up by compiling simpl.bnf and by loading its artifact
+void startup();
+// lexing and parsing alone, interleaved on one thread and pipelined on two
+void frontend(std::string const &source);
+// the generated descent parser against the table one, on the source and on every single token edit of it
+// the csts differ in how operators nest, so they are compared by their terminals and their asts
+void descent(std::string const &source);
+
+// editing copies of the source at random, relexing what each edit touches, against lexing the edited text whole
+// the edits open and close strings and comments, so some of them relex far past where they are
+void relex(std::string const &source);
+// editing about 100k lines of copies of the source at random, reparsing what each edit touches, checked against
+// parsing the edited text whole
+void incremental(std::string const &source);
+// parsing into an ast, digesting and solving it and destroying it for inputs a million deep, each on a thread with a
+// stack of 256 KiB
+void stress();
+// interning a million names on several threads at once, each has to get the same ids, and looking them up again
+void symbols();
+
+} // namespace bench
@@ -0,0 +1,10 @@
+# writes OUTPUT defining buildId() as a hash of the files in SOURCES, separated by |
+string(REPLACE "|" ";" sources "${SOURCES}")
+set(hashes "")
+foreach(source IN LISTS sources)
+    file(SHA256 ${source} hash)
+    string(APPEND hashes ${hash})
+endforeach()
+string(SHA256 id "${hashes}")
+string(SUBSTRING ${id} 0 16 id)
+file(WRITE ${OUTPUT} "#include \"buildid.h\"\n\nstd::string_view buildId() {\n    return \"${id}\";\n}\n")
@@ -0,0 +1,5 @@
+#pragma once
+
+// a hash of the sources simplc is built from, generated by the build, anything derived from a run of another
+// build of it is not trusted
+std::string_view buildId();
@@ -1,12 +1,13 @@
 #include "cfg.h"
-#include "lexer.h"
+#include "lexicon.h"
 #include "outs.h"
+#include "source.h"
 
 using namespace token;
 using namespace node;
 
 int genCFG(Nonterm &self, std::map<Kind, std::vector<std::vector<Kind>>> &ctx, Kind lhs = Kind::Invalid) {
-    auto get = [&self](auto idx) { return self.args[self.size - 1 - idx].get(); };
+    auto get = [&self](auto idx) { return self.args[idx]; };
     auto nonterm = [&get](auto idx) -> Nonterm & { return *static_cast<Nonterm *>(get(idx)); };
     switch (self.kind.value()) {
     case Kind::GRoot:
@@ -36,97 +37,8 @@ int genCFG(Nonterm &self, std::map<Kind, std::vector<std::vector<Kind>>> &ctx, K
     return 0;
 }
 
-std::vector<std::shared_ptr<Base>> const bnfSymbols{
-    std::make_shared<CharRegion>('`', '`', Kind::GEpsilon),
-    std::make_shared<StrFixed>("::=", Kind::BnfEqual),
-    std::make_shared<StrFixed>("<+>", Kind::ChevronsOr),
-    std::make_shared<StrFixed>("<$>", Kind::ChevronsEnd),
-    std::make_shared<CharFixed>('=', Kind::SingleEqual),
-    std::make_shared<StrFixed>("==", Kind::DoubleEqual),
-    std::make_shared<StrFixed>("!=", Kind::ExclamationEqual),
-    std::make_shared<CharFixed>(':', Kind::SingleColon),
-    std::make_shared<StrFixed>("::", Kind::DoubleColon),
-    std::make_shared<CharFixed>('(', Kind::OpenParenthesis),
-    std::make_shared<CharFixed>(')', Kind::CloseParenthesis),
-    std::make_shared<CharFixed>('[', Kind::OpenSquareBracket),
-    std::make_shared<CharFixed>(']', Kind::CloseSquareBracket),
-    std::make_shared<CharFixed>('{', Kind::OpenCurlyBracket),
-    std::make_shared<CharFixed>('}', Kind::CloseCurlyBracket),
-    std::make_shared<CharFixed>('<', Kind::LessThan),
-    std::make_shared<CharFixed>('>', Kind::GreatThan),
-    std::make_shared<StrFixed>("<=", Kind::LessThanOrEqual),
-    std::make_shared<StrFixed>(">=", Kind::GreatThanOrEqual),
-    std::make_shared<CharFixed>('&', Kind::SingleAnd),
-    std::make_shared<StrFixed>("&&", Kind::DoubleAnd),
-    std::make_shared<CharFixed>('|', Kind::SingleOr),
-    std::make_shared<StrFixed>("||", Kind::DoubleOr),
-    std::make_shared<CharFixed>('+', Kind::SinglePlus),
-    std::make_shared<StrFixed>("++", Kind::DoublePlus),
-    std::make_shared<CharFixed>('-', Kind::SingleMinus),
-    std::make_shared<StrFixed>("--", Kind::DoubleMinus),
-    std::make_shared<CharFixed>('*', Kind::SingleAsterisk),
-    std::make_shared<StrFixed>("**", Kind::DoubleAsterisk),
-    std::make_shared<CharFixed>('/', Kind::SingleSlash),
-    std::make_shared<StrFixed>("//", Kind::DoubleSlash),
-    std::make_shared<CharFixed>('%', Kind::Percent),
-    std::make_shared<CharFixed>('.', Kind::Dot),
-    std::make_shared<CharFixed>(',', Kind::Comma),
-    std::make_shared<CharFixed>(';', Kind::Semicolon),
-    std::make_shared<CharFixed>('!', Kind::Exclamation),
-    std::make_shared<CharFixed>('?', Kind::Question),
-    std::make_shared<CharFixed>('#', Kind::Hash),
-    std::make_shared<StrFixed>("<=>", Kind::Spaceship),
-    std::make_shared<StrFixed>("module", Kind::Module),
-    std::make_shared<StrFixed>("Root", Kind::Root),
-    std::make_shared<StrFixed>("epsilon", Kind::epsilon),
-    std::make_shared<StrFixed>("Stmt", Kind::Stmt),
-    std::make_shared<StrFixed>("Stmt'", Kind::Stm_),
-    std::make_shared<StrFixed>("Expr", Kind::Expr),
-    std::make_shared<StrFixed>("Expr'", Kind::Exp_),
-    std::make_shared<StrFixed>("Fact", Kind::Fact),
-    std::make_shared<StrFixed>("Fact'", Kind::Fac_),
-    std::make_shared<StrFixed>("Unary", Kind::Unary),
-    std::make_shared<StrFixed>("Binary", Kind::Binary),
-    std::make_shared<StrFixed>("LtoR", Kind::LtoR),
-    std::make_shared<StrFixed>("RtoL", Kind::RtoL),
-    std::make_shared<StrFixed>("Number", Kind::Number),
-    std::make_shared<StrFixed>("Id", Kind::Id),
-    std::make_shared<StrFixed>("Atom", Kind::Atom),
-    std::make_shared<StrFixed>("IModule", Kind::IModule),
-    std::make_shared<StrFixed>("Set", Kind::Set),
-    std::make_shared<StrFixed>("Extract", Kind::Extract),
-    std::make_shared<StrFixed>("Annot", Kind::Annot),
-    std::make_shared<StrFixed>("Bool", Kind::Bool),
-    std::make_shared<StrFixed>("Op1", Kind::Op1),
-    std::make_shared<StrFixed>("Op2", Kind::Op2),
-    std::make_shared<StrFixed>("Op3", Kind::Op3),
-    std::make_shared<StrFixed>("Op4", Kind::Op4),
-    std::make_shared<StrFixed>("Op5", Kind::Op5),
-    std::make_shared<StrFixed>("Op6", Kind::Op6),
-    std::make_shared<StrFixed>("Op7", Kind::Op7),
-    std::make_shared<StrFixed>("Op8", Kind::Op8),
-    std::make_shared<StrFixed>("Op9", Kind::Op9),
-    std::make_shared<StrFixed>("Exp1", Kind::Exp1),
-    std::make_shared<StrFixed>("Exp2", Kind::Exp2),
-    std::make_shared<StrFixed>("Exp3", Kind::Exp3),
-    std::make_shared<StrFixed>("Exp4", Kind::Exp4),
-    std::make_shared<StrFixed>("Exp5", Kind::Exp5),
-    std::make_shared<StrFixed>("Exp6", Kind::Exp6),
-    std::make_shared<StrFixed>("Exp7", Kind::Exp7),
-    std::make_shared<StrFixed>("Exp8", Kind::Exp8),
-    std::make_shared<StrFixed>("Exp9", Kind::Exp9),
-    std::make_shared<StrFixed>("Exp1'", Kind::Exp1_),
-    std::make_shared<StrFixed>("Exp2'", Kind::Exp2_),
-    std::make_shared<StrFixed>("Exp3'", Kind::Exp3_),
-    std::make_shared<StrFixed>("Exp4'", Kind::Exp4_),
-    std::make_shared<StrFixed>("Exp5'", Kind::Exp5_),
-    std::make_shared<StrFixed>("Exp6'", Kind::Exp6_),
-    std::make_shared<StrFixed>("Exp7'", Kind::Exp7_),
-    std::make_shared<StrFixed>("Exp8'", Kind::Exp8_),
-    std::make_shared<StrFixed>("Exp9'", Kind::Exp9_),
-    std::make_shared<StrFixed>("Super", Kind::Super),
-    std::make_shared<StrFixed>("Params", Kind::Params),
-};
+constexpr lexicon::Bnf bnfLexicon;
+
 
 Parser::CFG const cfgcfg{
     {Kind::GRoot, {{Kind::GFact, Kind::ChevronsEnd, Kind::GRoot}, {Kind::GEpsilon}}},
@@ -239,11 +151,10 @@ void LangCFG::test() {
     };
 
     Parser parser;
-    parser.setupGramma(cfgcfg, Kind::GRoot, Kind::GEpsilon);
-    parser.setRawText(question);
+    report(parser.setupGramma(cfgcfg, Kind::GRoot, Kind::GEpsilon));
 
     Lexer lexer(question);
-    for (auto next = lexer.next(bnfSymbols); !lexer.empty(); next = lexer.next(bnfSymbols)) {
+    for (auto next = lexer.next(bnfLexicon); !lexer.empty(); next = lexer.next(bnfLexicon)) {
         Diagn(), "== ", next.kind.name(), " ", next.view, " ==\n";
         parser.parse(next);
     }
@@ -252,24 +163,61 @@ void LangCFG::test() {
     if (parser.getCst().empty()) {
         Quiet(), "cst empty\n", exit(1);
     }
-    genCFG(*static_cast<Nonterm *>(parser.getCst()._Get_container().front().get()), answer);
+    genCFG(*static_cast<Nonterm *>(parser.getCst().front()), answer);
 
     Quiet(), "test ", answer == sampleAnswer ? "ok" : "failed", '\n';
 }
 
-Parser::CFG LangCFG::getCFG() {
+std::vector<std::shared_ptr<Base>> const &LangCFG::getSymbols() {
+    static auto const symbols = lexicon::Simpl::symbols();
+    return symbols;
+}
+
+uint64_t LangCFG::key() {
+    // the kinds are the numbering the artifact is written in, changing them invalidates it too
+    auto res = fnv1a(Source("simpl.bnf").view());
+    for (uint16_t k{}; k < Kind::Size; ++k) {
+        res = fnv1a(Kind(k).name(), res);
+    }
+    return res;
+}
+
+void LangCFG::setup(Parser &parser) {
+    constexpr auto artifactName = "simpl.bnf.bin";
+
+    auto const key = LangCFG::key();
+    if (std::error_code ec; std::filesystem::exists(artifactName, ec) && parser.load(Source(artifactName).view(), key)) {
+        return;
+    }
+
+    report(parser.setupGramma(getCFG()));
+    replaceFile(artifactName, parser.save(key));
+}
+
+Parser::CFG const &LangCFG::getBnfCFG() {
+    return cfgcfg;
+}
+
+void LangCFG::report(std::vector<Parser::Conflict> const &conflicts) {
+    auto const rule = [](int r) { return r < 0 ? std::string("epsilon") : std::format("rule[{}]", r); };
+    for (auto const &c : conflicts) {
+        auto const msg = std::format("{} on '{}': {} over {}\n", c.nonterm.show(), c.input.show(), rule(c.kept), rule(c.dropped));
+        Quiet<style::red>(), "ll(1) conflict: ", msg;
+    }
+}
+
+Parser::CFG LangCFG::getCFG(std::string const &bnf) {
     Parser parser;
-    parser.setupGramma(cfgcfg, Kind::GRoot, Kind::GEpsilon);
+    report(parser.setupGramma(cfgcfg, Kind::GRoot, Kind::GEpsilon));
 
-    std::ifstream file("simpl.bnf");
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    auto str = buffer.str();
+    SourceManager sources;
+    auto const str = sources.load(bnf);
+    parser.setSources(sources);
 
     Lexer lexer(str);
-    auto next = lexer.next(bnfSymbols);
+    auto next = lexer.next(bnfLexicon);
     int err{};
-    for (; !lexer.empty(); next = lexer.next(bnfSymbols)) {
+    for (; !lexer.empty(); next = lexer.next(bnfLexicon)) {
         Diagn(), "== ", next.kind.name(), " ", next.view, " ==\n";
         err += parser.parse(next);
     }
@@ -281,7 +229,7 @@ Parser::CFG LangCFG::getCFG() {
         exit(1);
     }
 
-    genCFG(*static_cast<Nonterm *>(parser.getCst()._Get_container().front().get()), langCFG);
+    genCFG(*static_cast<Nonterm *>(parser.getCst().front()), langCFG);
 
     Quiet(), style::red;
     if (next.view.length() > 1) {
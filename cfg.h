@@ -1,8 +1,20 @@
 #pragma once
 #include "parser.h"
 
+namespace token {
+struct Base;
+}
+
 class LangCFG {
 public:
     static void test();
-    static Parser::CFG getCFG();
+    static std::vector<std::shared_ptr<token::Base>> const &getSymbols();
+    static Parser::CFG getCFG(std::string const &bnf = "simpl.bnf");
+    // what the artifacts built from simpl.bnf are keyed by, its text and the numbering of the kinds
+    static uint64_t key();
+    // sets parser up for simpl.bnf, from the compiled artifact next to it while that matches the grammar
+    static void setup(Parser &parser);
+    static void report(std::vector<Parser::Conflict> const &conflicts);
+    // the grammar of bnf itself, rooted at GRoot
+    static Parser::CFG const &getBnfCFG();
 };
@@ -0,0 +1,66 @@
+#include "descent.h"
+#include "outs.h"
+
+using namespace node;
+
+Descent::Descent(TokenStream const &stream, SourceManager const *sources) : _stream(stream), _sources(sources) {}
+
+Token *Descent::shift(Kind kind) {
+    if (peek() != kind) return expected({kind});
+    auto *token = _arena.make<Token>(kind, _stream.view(_at));
+    _at += _at + 1 < _stream.size();
+    return token;
+}
+
+Token *Descent::vanish(Kind epsilon) {
+    return _arena.make<Token>(epsilon, _stream.view(_at).substr(0, 0));
+}
+
+Nonterm *Descent::open(Kind kind, size_t size) {
+    auto *nonterm = _arena.make<Nonterm>(kind);
+    nonterm->args = _arena.array<Token *>(size);
+    nonterm->size = static_cast<int>(size);
+    return nonterm;
+}
+
+Token *Descent::close(Kind kind, Token *head) {
+    // the nested ones end where the innermost does, so their views are set without recursing
+    auto const *last = head;
+    while (last->kind == kind) {
+        last = last->cast<Nonterm>().args.back();
+    }
+    for (auto *t = head; t->kind == kind;) {
+        auto &nonterm = t->cast<Nonterm>();
+        nonterm.view = nonterm.args.front()->combine(*last).view;
+        t = nonterm.args.back();
+    }
+    return head;
+}
+
+std::nullptr_t Descent::expected(std::initializer_list<Kind> kinds) {
+    ++_errors;
+    Quiet<style::red>(), "expected ";
+    for (auto k : kinds) {
+        Quiet<style::red>(), '\'', k.show(), '\'', ' ';
+    }
+    Quiet(), '\n';
+    if (_sources) Node(_stream.view(_at)).printCode(*_sources);
+    return nullptr;
+}
+
+Token *Descent::climb(Parse operand, int (*binds)(Kind), int min) {
+    // tighter operators are taken by the recursion, equal ones left to right by the loop
+    auto *lhs = operand(*this);
+    for (int power; lhs && (power = binds(peek())) >= min;) {
+        auto *op = shift(peek());
+        auto *rhs = climb(operand, binds, power + 1);
+        if (!rhs) return nullptr;
+        auto *binary = open(Kind::Binary, 3);
+        binary->args[0] = lhs;
+        binary->args[1] = op;
+        binary->args[2] = rhs;
+        binary->view = lhs->combine(*rhs).view;
+        lhs = binary;
+    }
+    return lhs;
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include "arena.h"
+#include "tokens.h"
+
+// recursive descent over a pre-lexed input, building a cst into its own arena
+// its terminals and the ast made of it are those of Parser, its shape is not: climb nests the operators as binaries
+// the function per nonterminal and parse itself are generated from simpl.bnf at build time by simplgen
+class Descent {
+public:
+    using Parse = node::Token *(*)(Descent &);
+    explicit Descent(TokenStream const &stream, SourceManager const *sources = nullptr);
+    // the cst of the whole input, none after the first syntax error
+    node::Token *parse();
+    int errors() const { return _errors; }
+
+    // the steps the generated functions are made of
+    Kind peek() const { return _stream.kind(_at); }
+    // the lookahead if it is kind, otherwise a syntax error
+    node::Token *shift(Kind kind);
+    // the epsilon a nonterminal deriving nothing turns into, in front of the lookahead
+    node::Token *vanish(Kind epsilon);
+    // a nonterminal with room for size args
+    node::Nonterm *open(Kind kind, size_t size);
+    // covers head with its args, a chain of kind nested through the last args as well
+    node::Token *close(Kind kind, node::Token *head);
+    std::nullptr_t expected(std::initializer_list<Kind> kinds);
+    // operands joined by the infix operators binding at least min, into Binary nodes of lhs, operator and rhs
+    // binds gives how tight an operator binds, 0 for anything else
+    node::Token *climb(Parse operand, int (*binds)(Kind), int min);
+
+private:
+    TokenStream const &_stream;
+    uint32_t _at{};
+    SourceManager const *_sources;
+    Arena _arena;
+    int _errors{};
+};
@@ -0,0 +1,250 @@
+#include "cfg.h"
+#include "outs.h"
+
+// simplgen writes the recursive descent parser Descent::parse runs, from the ll(1) table of a grammar
+// every nonterminal becomes a function switching on the lookahead, the alternatives ending in the
+// nonterminal itself loop instead of recursing
+// a chain of levels like Exp3 ::= Exp2 Exp3', Exp3' ::= epsilon <+> Op3 Exp2 Exp3' is parsed by precedence
+// climbing instead, with the operators of the Op rules binding the tighter the lower their level
+
+namespace {
+
+// kinds are written by value, their names do not always spell the enumerators
+std::string kind(Kind k) {
+    return std::format("Kind({})", k.value());
+}
+
+std::string call(Parser const &parser, Kind k) {
+    return parser.isNonterm(k) ? std::format("parse{}(d)", k.name()) : std::format("d.shift({})", kind(k));
+}
+
+// the distinct productions of a nonterminal, the nullable one included
+std::vector<int> productions(Parser const &parser, Kind nonterm) {
+    std::vector<int> res;
+    for (uint16_t k{}; k < Kind::Size; ++k) {
+        auto const p = parser.lookup(nonterm, k);
+        if (p >= 0 && std::ranges::find(res, p) == res.end()) res.push_back(p);
+    }
+    return res;
+}
+
+struct Chain {
+    Kind operand;                  // what the operators join
+    std::map<uint16_t, int> power; // of the levels and of their operators, the tightest binds the most
+};
+
+// the longest chain of operator levels, if the grammar has one
+std::optional<Chain> findChain(Parser const &parser) {
+    struct Level {
+        Kind sub;
+        std::vector<Kind> ops;
+    };
+    std::map<uint16_t, Level> levels;
+    for (uint16_t k{}; k < Kind::Size; ++k) {
+        if (!parser.isNonterm(k)) continue;
+        auto const ps = productions(parser, k);
+        if (ps.size() != 1) continue;
+        auto const body = parser.getProduction(ps[0]);
+        if (body.size() != 2 || !parser.isNonterm(body[0]) || !parser.isNonterm(body[1])) continue;
+        auto const sub = body[0], tail = body[1];
+        std::optional<Kind> op;
+        bool nullable{};
+        for (auto p : productions(parser, tail)) {
+            auto const alt = parser.getProduction(p);
+            if (alt.size() == 1 && alt[0] == parser.getEpsilon()) {
+                nullable = true;
+            } else if (alt.size() == 3 && parser.isNonterm(alt[0]) && alt[1] == sub && alt[2] == tail && !op) {
+                op = alt[0];
+            } else {
+                op.reset();
+                break;
+            }
+        }
+        if (!nullable || !op) continue;
+        Level level{sub, {}};
+        for (auto p : productions(parser, *op)) {
+            auto const alt = parser.getProduction(p);
+            if (alt.size() != 1 || parser.isNonterm(alt[0]) || alt[0] == parser.getEpsilon()) break;
+            level.ops.push_back(alt[0]);
+        }
+        if (level.ops.size() == productions(parser, *op).size()) levels.emplace(k, level);
+    }
+
+    std::optional<Chain> best;
+    size_t longest{};
+    for (auto const &[k, level] : levels) {
+        if (levels.contains(level.sub.value())) continue; // not the tightest level
+        std::vector<Kind> chain{k};
+        for (bool more = true; more;) {
+            more = false;
+            for (auto const &[next, above] : levels) {
+                if (above.sub == chain.back()) {
+                    chain.push_back(next);
+                    more = true;
+                    break;
+                }
+            }
+        }
+        if (chain.size() <= longest) continue;
+        Chain res{level.sub, {}};
+        for (size_t i{}; i < chain.size(); ++i) {
+            auto const power = static_cast<int>(chain.size() - i);
+            res.power[chain[i].value()] = power;
+            for (auto op : levels.at(chain[i].value()).ops) {
+                if (!res.power.emplace(op.value(), power).second) return std::nullopt; // ambiguous operator
+            }
+        }
+        longest = chain.size();
+        best = std::move(res);
+    }
+    return best;
+}
+
+// the nonterminals parsing from the root calls, the chain calls its operand only
+std::vector<Kind> reachable(Parser const &parser, std::optional<Chain> const &chain) {
+    std::vector<bool> seen(Kind::Size);
+    std::vector<Kind> todo{parser.getRoot()};
+    seen[parser.getRoot().value()] = true;
+    while (!todo.empty()) {
+        auto const k = todo.back();
+        todo.pop_back();
+        std::vector<Kind> calls;
+        if (chain && chain->power.contains(k.value()) && parser.isNonterm(k)) {
+            calls.push_back(chain->operand);
+        } else {
+            for (auto p : productions(parser, k)) {
+                auto const alt = parser.getProduction(p);
+                calls.insert(calls.end(), alt.begin(), alt.end());
+            }
+        }
+        for (auto c : calls) {
+            if (parser.isNonterm(c) && !seen[c.value()]) {
+                seen[c.value()] = true;
+                todo.push_back(c);
+            }
+        }
+    }
+    std::vector<Kind> res;
+    for (uint16_t k{}; k < Kind::Size; ++k) {
+        if (seen[k]) res.push_back(k);
+    }
+    return res;
+}
+
+std::string cases(std::vector<Kind> const &kinds, std::string_view indent) {
+    std::string res;
+    for (auto k : kinds) {
+        res += std::format("{}case {}: // {}\n", indent, k.value(), k.name());
+    }
+    return res;
+}
+
+std::string emit(Parser const &parser, Kind nonterm) {
+    auto const name = nonterm.name();
+    std::map<int, std::vector<Kind>> productions; // by the inputs they are chosen on
+    std::vector<Kind> vanish, expected;
+    for (uint16_t k{}; k < Kind::Size; ++k) {
+        auto const action = parser.lookup(nonterm, k);
+        if (action >= 0) expected.push_back(k);
+        if (k == parser.getEpsilon().value()) continue;
+        if (action >= 0) {
+            productions[action].push_back(k);
+        } else if (action == Parser::Vanish) {
+            vanish.push_back(k);
+        }
+    }
+    auto const loops = std::ranges::any_of(productions, [&](auto const &p) {
+        return parser.getProduction(p.first).back() == nonterm;
+    });
+    std::string expect;
+    for (auto k : expected) {
+        expect += std::format("{}{}", expect.empty() ? "" : ", ", kind(k));
+    }
+
+    // the loop keeps where the next link of the chain goes
+    std::string_view const in = loops ? "        " : "    ";
+    auto res = std::format("Token *parse{}(Descent &d) {{\n", name);
+    if (loops) res += "    Token *head{};\n    for (auto **at = &head;;) {\n";
+    res += std::format("{}switch (d.peek().value()) {{\n", in);
+    for (auto const &[p, inputs] : productions) {
+        auto const symbols = parser.getProduction(p);
+        auto const tail = loops && symbols.back() == nonterm;
+        res += cases(inputs, in);
+        res += std::format("{}{{\n", in);
+        res += std::format("{}    auto *self = d.open({}, {});\n", in, kind(nonterm), symbols.size());
+        if (loops) res += std::format("{}    *at = self;\n", in);
+        for (size_t i{}; i < symbols.size() - tail; ++i) {
+            res += std::format("{}    if (!(self->args[{}] = {})) return nullptr;\n", in, i, call(parser, symbols[i]));
+        }
+        if (tail) {
+            res += std::format("{}    at = &self->args[{}];\n{}    continue;\n", in, symbols.size() - 1, in);
+        } else {
+            res += std::format("{}    return d.close({}, {});\n", in, kind(nonterm), loops ? "head" : "self");
+        }
+        res += std::format("{}}}\n", in);
+    }
+    if (!vanish.empty()) {
+        res += cases(vanish, in);
+        auto const epsilon = std::format("d.vanish({})", kind(parser.getEpsilon()));
+        if (loops) {
+            res += std::format("{}    *at = {};\n{}    return d.close({}, head);\n", in, epsilon, in, kind(nonterm));
+        } else {
+            res += std::format("{}    return {};\n", in, epsilon);
+        }
+    }
+    res += std::format("{}default: return d.expected({{{}}});\n{}}}\n", in, expect, in);
+    if (loops) res += "    }\n";
+    res += "}\n";
+    return res;
+}
+
+std::string emit(Parser const &parser) {
+    auto const chain = findChain(parser);
+    auto const nonterms = reachable(parser, chain);
+    std::string res = "// generated by simplgen, do not edit\n"
+                      "#include \"descent.h\"\n\n"
+                      "using namespace node;\n\n"
+                      "namespace {\n\n";
+    for (auto k : nonterms) {
+        res += std::format("Token *parse{}(Descent &d);\n", k.name());
+    }
+    if (chain) {
+        res += "\nint binds(Kind op) {\n    switch (op.value()) {\n";
+        for (auto const &[k, power] : chain->power) {
+            if (parser.isNonterm(k)) continue;
+            res += std::format("    case {}: return {}; // {}\n", k, power, Kind(k).name());
+        }
+        res += "    default: return 0;\n    }\n}\n";
+    }
+    for (auto k : nonterms) {
+        if (chain && chain->power.contains(k.value())) {
+            res += std::format("\nToken *parse{}(Descent &d) {{\n    return d.climb(parse{}, binds, {});\n}}\n",
+                               k.name(), chain->operand.name(), chain->power.at(k.value()));
+        } else {
+            res += '\n' + emit(parser, k);
+        }
+    }
+    res += "\n} // namespace\n\n";
+    res += std::format("Token *Descent::parse() {{\n"
+                       "    auto *root = parse{}(*this);\n"
+                       "    return root && shift(Kind::Eof) ? root : nullptr;\n"
+                       "}}\n",
+                       parser.getRoot().name());
+    return res;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    if (argc != 3) {
+        Quiet<style::red>(), "usage: simplgen <grammar.bnf> <parser.cpp>\n";
+        return 1;
+    }
+    setVerbosity(Verbosity::Quiet);
+    Parser parser;
+    auto const conflicts = parser.setupGramma(LangCFG::getCFG(argv[1]));
+    LangCFG::report(conflicts);
+    std::ofstream out(argv[2], std::ios::binary);
+    out << emit(parser);
+    return conflicts.empty() && out ? 0 : 1;
+}
@@ -0,0 +1,135 @@
+#include "incremental.h"
+#include "ast.h"
+#include "tokens.h"
+
+namespace {
+
+// the kinds of tokens for topLevelCommas, whose top-level commas are the only ones separating the facts of the root
+auto kinds(std::vector<Relexer::Token> const &tokens) {
+    return [&tokens](size_t i) { return tokens[i].kind; };
+}
+
+// the part of the fenwick tree node i sums up, and the step to the next one covering it
+size_t lowest(size_t i) {
+    return i & (~i + 1);
+}
+
+} // namespace
+
+Incremental::Incremental(Parser const &parser, token::Dfa const &dfa) : _dfa(dfa) {
+    _parser.load(parser.save(0), 0);
+    _parser.setReporting(false);
+}
+
+int Incremental::parse(std::string const &text) {
+    _relexer.emplace(_dfa, text);
+    return _parseAll();
+}
+
+int Incremental::edit(size_t offset, size_t length, std::string_view text) {
+    _relexer->edit(offset, length, text);
+    auto const [b, at] = _find(offset);
+    if (at + length <= _blocks[b]->text.size()) {
+        auto edited = std::make_unique<Block>();
+        edited->text = _blocks[b]->text;
+        edited->text.replace(at, length, text);
+        if (_parse(*edited, offset - at, b + 1 == _blocks.size())) {
+            _errors += edited->errors - _blocks[b]->errors;
+            _resize(b, edited->text.size());
+            _blocks[b] = std::move(edited);
+            return _errors;
+        }
+    }
+    ++_fallbacks;
+    return _parseAll();
+}
+
+std::string Incremental::text() const {
+    return _relexer ? _relexer->text() : std::string{};
+}
+
+std::vector<std::pair<node::Ast const *, node::Ref>> Incremental::trees() const {
+    std::vector<std::pair<node::Ast const *, node::Ref>> res;
+    for (auto const &block : _blocks) {
+        res.emplace_back(&block->ast, block->statements);
+    }
+    return res;
+}
+
+int Incremental::_parseAll() {
+    auto const text = _relexer->text();
+    std::vector<size_t> ends;
+    {
+        auto const tokens = _relexer->tokens(0, _relexer->size());
+        topLevelCommas(tokens.size(), kinds(tokens), [&](size_t i) { ends.push_back(tokens[i].end); });
+        ends.push_back(text.size());
+    }
+
+    _blocks.clear();
+    _sizes.assign(ends.size() + 1, 0);
+    _errors = 0;
+    size_t begin{};
+    for (size_t b{}; b < ends.size(); ++b) {
+        auto &block = *_blocks.emplace_back(std::make_unique<Block>());
+        block.text.assign(text, begin, ends[b] - begin);
+        _parse(block, begin, b + 1 == ends.size());
+        begin = ends[b];
+        _errors += block.errors;
+        // linear fenwick construction, every node passes its sum on to its parent
+        _sizes[b + 1] += block.text.size();
+        if (auto const parent = b + 1 + lowest(b + 1); parent < _sizes.size()) {
+            _sizes[parent] += _sizes[b + 1];
+        }
+    }
+    return _errors;
+}
+
+bool Incremental::_parse(Block &block, size_t offset, bool last) {
+    auto const end = offset + block.text.size();
+    auto const tokens = _relexer->tokens(_relexer->find(offset), last ? _relexer->size() : _relexer->find(end));
+    if (!last && (tokens.empty() || tokens.back().end > end)) return false; // a token runs on into the next block
+    size_t commas{};
+    bool ends{}; // in a comma, the last token of the block
+    topLevelCommas(tokens.size(), kinds(tokens), [&](size_t i) {
+        ++commas;
+        ends = i + 1 == tokens.size();
+    });
+    if (last ? commas > 0 : commas != 1 || !ends) return false;
+
+    // as the block would lex alone, no token starts with the comma before it
+    auto const view = [&](Relexer::Token const &t) {
+        return std::string_view(block.text).substr(t.begin - offset, t.end - t.begin);
+    };
+    block.errors = static_cast<int>(std::ranges::count(tokens, Kind(Kind::Invalid), &Relexer::Token::kind));
+    _parser.setReduce(reduceInto(block.ast));
+    for (auto const &token : tokens) {
+        if (token.kind == Kind::Comment || token.kind == Kind::Invalid) continue;
+        if (token.kind == Kind::Eof) block.errors += token.end > token.begin; // the rest of an unfinished token
+        block.errors += _parser.parse(node::Token(token.kind, view(token)));
+    }
+    if (!last) block.errors += _parser.parse(node::Token(Kind::Eof, std::string_view(block.text).substr(end - offset)));
+    block.statements = block.errors > 0 ? node::Ref{} : _parser.getValues().front().ast;
+    if (!block.statements) block.ast = {};
+    _parser.restart();
+    return true;
+}
+
+std::pair<size_t, size_t> Incremental::_find(size_t offset) const {
+    // the most blocks whose texts together end at or before offset
+    size_t count{}, rest = offset;
+    for (auto step = std::bit_floor(_blocks.size()); step > 0; step >>= 1) {
+        if (count + step < _sizes.size() && _sizes[count + step] <= rest) {
+            count += step;
+            rest -= _sizes[count];
+        }
+    }
+    if (count < _blocks.size()) return {count, rest};
+    return {_blocks.size() - 1, rest + _blocks.back()->text.size()}; // the end of the text
+}
+
+void Incremental::_resize(size_t block, size_t size) {
+    auto const delta = size - _blocks[block]->text.size(); // wraps around when it shrinks, so does the sum
+    for (auto i = block + 1; i < _sizes.size(); i += lowest(i)) {
+        _sizes[i] += delta;
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include "parser.h"
+#include "relexer.h"
+
+// a document kept as its top-level facts and modules, each with a copy of its text and the ast parsed from it
+// the tokens are those of a relexer over the whole document, an edit relexes what it touches and reparses the fact
+// or module it falls into alone, the asts of all the others are kept as they are
+// an edit moving a top-level comma, spanning two of them or relexing past one parses the whole document again
+// the unit reparsed is the top-level one, not the innermost fact or module around the edit: an edit anywhere in a
+// module takes time in the size of the whole module, a document of one large module is reparsed whole every time
+// a building block for an editor or a language server keeping a document open, the compiler parses its input once
+// and does not use it, only --bench-incremental drives it
+class Incremental {
+public:
+    Incremental(Parser const &parser, token::Dfa const &dfa);
+    // parses text as a whole, returns the syntax errors
+    int parse(std::string const &text);
+    // replaces length bytes at offset by text, returns the syntax errors of the whole document
+    int edit(size_t offset, size_t length, std::string_view text);
+    int errors() const { return _errors; }
+    // the edits that had to parse the whole document
+    size_t fallbacks() const { return _fallbacks; }
+    std::string text() const;
+    // the ast of each block and its statements in order, none after syntax errors, valid until the block is edited
+    std::vector<std::pair<node::Ast const *, node::Ref>> trees() const;
+
+private:
+    // never moves, the views of its ast point into its text
+    struct Block {
+        std::string text; // up to the comma ending the fact, the last one up to the end
+        node::Ast ast;
+        node::Ref statements; // none after syntax errors
+        int errors{};
+    };
+
+    // splits the tokens of the relexer into blocks at its top-level commas and parses them, returns the syntax errors
+    int _parseAll();
+    // the block starts at offset in the document, false if its tokens no longer end in its only top-level comma,
+    // or the last one has one
+    bool _parse(Block &block, size_t offset, bool last);
+    // the block holding offset and the offset in it
+    std::pair<size_t, size_t> _find(size_t offset) const;
+    void _resize(size_t block, size_t size);
+
+private:
+    Parser _parser;
+    token::Dfa const &_dfa;
+    std::optional<Relexer> _relexer;
+    std::vector<std::unique_ptr<Block>> _blocks;
+    std::vector<size_t> _sizes; // fenwick tree over the sizes of the texts of the blocks, from 1
+    int _errors{};
+    size_t _fallbacks{};
+};
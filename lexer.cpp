@@ -1,29 +1,245 @@
 #include "lexer.h"
 #include "outs.h"
 
+token::Dfa::Dfa(std::vector<std::shared_ptr<Base>> const &tokens) {
+    // a state is the step state of every token, negative for the filtered ones
+    std::vector<std::vector<int>> states{std::vector<int>(tokens.size())};
+    std::map<std::vector<int>, int32_t> ids{
+        {states.front(), 0}
+    };
+    std::vector<std::array<int32_t, 256>> wide;
+
+    for (size_t i{}; i < states.size(); ++i) {
+        auto const current = states[i];
+        auto &row = wide.emplace_back();
+        for (int ch{}; ch < 256; ++ch) {
+            std::vector<int> next(tokens.size(), -1);
+            Kind first = Kind::Invalid;
+            bool alive{}, over{true};
+            for (size_t t{}; t < tokens.size(); ++t) {
+                if (current[t] < 0) continue;
+                auto const step = tokens[t]->step(current[t], static_cast<char>(ch));
+                if (step.state < 0) continue;
+                if (!alive) first = tokens[t]->kind;
+                next[t] = step.state;
+                alive = true;
+                over = over && step.over;
+            }
+            if (!alive) {
+                row[ch] = reject;
+            } else if (over) {
+                row[ch] = reject - 1 - first.value();
+            } else {
+                auto [it, inserted] = ids.emplace(next, static_cast<int32_t>(states.size()));
+                if (inserted) states.push_back(std::move(next));
+                row[ch] = it->second;
+            }
+        }
+    }
+
+    // bytes with the same column share a class
+    std::map<std::vector<int32_t>, uint8_t> columns;
+    for (int ch{}; ch < 256; ++ch) {
+        std::vector<int32_t> column;
+        for (auto const &row : wide) {
+            column.push_back(row[ch]);
+        }
+        _classes[ch] = columns.emplace(column, static_cast<uint8_t>(columns.size())).first->second;
+    }
+    auto const rejected = [&wide](char ch) { return wide[0][uint8_t(ch)] == reject; };
+    _skipsSpace = std::ranges::all_of(std::string_view(" \t\n\r"), rejected);
+    for (size_t s{}; s < wide.size(); ++s) {
+        std::vector<uint8_t> exits;
+        for (int ch{}; ch < 256; ++ch) {
+            if (wide[s][ch] != static_cast<int32_t>(s)) exits.push_back(uint8_t(ch));
+        }
+        auto const loops = [&exits](auto in) { return std::ranges::none_of(exits, [in](uint8_t ch) { return in(ch); }); };
+        auto &loop = _loops.emplace_back();
+        if (exits.size() == 1) {
+            loop = {Loop::Until, static_cast<char>(exits.front())};
+        } else if (loops(token::isBody)) {
+            loop.cls = Loop::Body;
+        } else if (loops([](char ch) { return token::isDigit(ch) || ch == '.'; })) {
+            loop.cls = Loop::Number;
+        }
+    }
+
+    _width = static_cast<uint32_t>(columns.size());
+    _table.resize(wide.size() * _width);
+    for (size_t s{}; s < wide.size(); ++s) {
+        for (int ch{}; ch < 256; ++ch) {
+            _table[s * _width + _classes[ch]] = wide[s][ch];
+        }
+    }
+}
+
+void Lexer::_undefined(std::string_view view) {
+    if (std::ranges::any_of(view, [](char c) { return !token::isSpace(c); })) {
+        if (_rejected) {
+            _rejected->push_back(view);
+        } else {
+            printUndefined(view);
+        }
+    }
+}
+
+void Lexer::printUndefined(std::string_view view) {
+    Quiet<style::red>(), "undefined input '", view, "'\n";
+}
+
+bool Lexer::finished(node::Token const &eof) {
+    if (eof.view.empty()) return true;
+    Quiet<style::red>(), "lex error: rest is '", eof.view, "'\n";
+    return false;
+}
+
+node::Token Lexer::next(token::Dfa const &dfa) {
+    auto const *const data = _string.data();
+    auto const *const end = data + _string.length();
+    int32_t state{};
+    for (;;) {
+        if (state == 0 && _begin == _now && dfa.skipsSpace()) {
+            _begin = _now = static_cast<uint32_t>(scan::spaces(data + _now, end) - data);
+        }
+        bool const atEnd = _now == _string.length();
+        if (atEnd && state == 0) break;
+        auto const action = dfa.next(state, data[_now]); // the sentinel at the end
+        if (token::Dfa::accepted(action)) {
+            auto v = _view(0);
+            _begin = _now;
+            return {token::Dfa::kind(action), v};
+        }
+        if (atEnd) {
+            if (action == token::Dfa::reject) {
+                _undefined(_view(0));
+                _begin = _now;
+            }
+            break;
+        }
+        if (action == token::Dfa::reject) {
+            _undefined(_view());
+            _begin = ++_now;
+            state = 0;
+        } else {
+            state = action;
+            _now = static_cast<uint32_t>(dfa.skip(state, data + _now + 1, end) - data);
+        }
+    }
+    ++_returnedEof;
+    return {Kind::Eof, _view(0)};
+}
+
+std::vector<node::Token> Lexer::lexAll(std::string_view str, token::Dfa const &dfa, unsigned jobs) {
+    constexpr size_t minChunk = 1 << 16;
+    jobs = static_cast<unsigned>(std::clamp<size_t>(str.size() / minChunk, 1, std::max(jobs, 1U)));
+    if (jobs > 1) return _lexChunks(str, dfa, jobs);
+    std::vector<node::Token> res;
+    Lexer lexer(str);
+    do {
+        res.push_back(lexer.next(dfa));
+    } while (res.back().kind != Kind::Eof);
+    return res;
+}
+
+std::vector<node::Token> Lexer::_lexChunks(std::string_view str, token::Dfa const &dfa, unsigned jobs) {
+    auto const offset = [str](node::Token const &t) { return static_cast<uint32_t>(t.view.data() - str.data()); };
+    auto const end = [&offset](node::Token const &t) { return offset(t) + static_cast<uint32_t>(t.view.size()); };
+
+    // chunks start at a line, where a guess of being outside comments and regions is most likely right
+    std::vector<uint32_t> starts{0};
+    for (unsigned i = 1; i < jobs; ++i) {
+        auto const line = str.find('\n', std::max<size_t>(str.size() * i / jobs, starts.back()));
+        if (line == std::string_view::npos || line + 1 >= str.size()) break;
+        if (line + 1 > starts.back()) starts.push_back(static_cast<uint32_t>(line + 1));
+    }
+    starts.push_back(static_cast<uint32_t>(str.size()));
+
+    struct Chunk {
+        std::vector<node::Token> tokens;
+        std::vector<std::string_view> rejected;
+    };
+    std::vector<Chunk> chunks(starts.size() - 1);
+    {
+        std::vector<std::jthread> threads;
+        for (size_t i{}; i < chunks.size(); ++i) {
+            threads.emplace_back([&, i] {
+                auto &chunk = chunks[i];
+                Lexer lexer(str);
+                lexer._rejected = &chunk.rejected;
+                lexer.seek(starts[i]);
+                do {
+                    chunk.tokens.push_back(lexer.next(dfa));
+                } while (chunk.tokens.back().kind != Kind::Eof && end(chunk.tokens.back()) < starts[i + 1]);
+            });
+        }
+    }
+
+    // the first chunk is right, every other one is taken from where the right stream ends on one of its tokens
+    auto res = std::move(chunks.front().tokens);
+    std::vector<std::string_view> rejected = std::move(chunks.front().rejected);
+    Lexer fixer(str);
+    fixer._rejected = &rejected;
+    for (size_t i = 1; i < chunks.size() && res.back().kind != Kind::Eof; ++i) {
+        auto const &tokens = chunks[i].tokens;
+        auto pos = end(res.back());
+        fixer.seek(pos);
+        for (;;) {
+            auto sync = tokens.begin();
+            if (pos != starts[i]) {
+                sync = std::ranges::partition_point(tokens, [&](node::Token const &t) { return end(t) < pos; });
+                sync = sync != tokens.end() && end(*sync) == pos ? sync + 1 : tokens.end();
+            }
+            if (sync != tokens.end()) {
+                res.insert(res.end(), sync, tokens.end());
+                for (auto const &view : chunks[i].rejected) {
+                    if (view.data() >= str.data() + pos) rejected.push_back(view);
+                }
+                break;
+            }
+            if (pos >= end(tokens.back())) break; // relexed past the whole chunk
+            res.push_back(fixer.next(dfa));
+            if (res.back().kind == Kind::Eof) break;
+            pos = end(res.back());
+        }
+    }
+    if (res.back().kind != Kind::Eof) {
+        fixer.seek(end(res.back()));
+        do {
+            res.push_back(fixer.next(dfa));
+        } while (res.back().kind != Kind::Eof);
+    }
+    for (auto const &view : rejected) {
+        printUndefined(view);
+    }
+    return res;
+}
+
 node::Token Lexer::next(std::vector<std::shared_ptr<token::Base>> const &tokens) {
     auto tmp = tokens;
 
-    for (; _now < _string.length();) {
-        auto const v = _view();
+    for (;;) {
+        bool const atEnd = _now == _string.length();
+        if (atEnd && _begin == _now) break;
+        auto const v = _view(); // the sentinel at the end
         std::erase_if(tmp, [this, v](auto e) { return !e->match(v) && !e->over(v); });
         if (tmp.empty()) {
-            if (std::ranges::any_of(v, [](char c) { return !token::isSpace(c); })) {
-                Quiet<style::red>(), "undefined input '", v, "'\n";
+            _undefined(atEnd ? _view(0) : v);
+            if (atEnd) {
+                _begin = _now;
+                break;
             }
             _begin = ++_now;
             tmp = tokens;
         } else if (std::ranges::all_of(tmp, [this](auto ptr) { return ptr->over(_view()); })) {
-            break; // greedy for the longest match
+            auto res = _view(0);
+            _begin = _now;
+            return {tmp.front()->kind, res}; // greedy for the longest match
+        } else if (atEnd) {
+            break;
         } else {
             ++_now;
         }
     }
-    auto v = _view(0);
-    if (_now == _string.length()) {
-        ++_returnedEof;
-        return {Kind::Eof, v};
-    }
-    _begin = _now;
-    return {tmp.front()->kind, v};
+    ++_returnedEof;
+    return {Kind::Eof, _view(0)};
 }
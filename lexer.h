@@ -1,32 +1,93 @@
 #pragma once
 #include "node.h"
+#include "scan.h"
+#include "utils.h"
 
 namespace token {
 
-inline bool isDigit(char ch) {
+constexpr bool isDigit(char ch) {
     return ch >= '0' && ch <= '9';
 }
 
-inline bool isAlpha(char ch) {
+constexpr bool isAlpha(char ch) {
     return ('a' <= ch && ch <= 'z') || ('A' <= ch && ch <= 'Z');
 }
 
-inline bool isHead(char ch) {
-    return isAlpha(ch) || ch == '_';
+// a byte of a multibyte character, the input is validated as utf-8 before it is lexed
+constexpr bool isUtf8(char ch) {
+    return static_cast<uint8_t>(ch) >= 0x80;
 }
 
-inline bool isBody(char ch) {
+constexpr bool isHead(char ch) {
+    return isAlpha(ch) || ch == '_' || isUtf8(ch);
+}
+
+constexpr bool isBody(char ch) {
     return isHead(ch) || isDigit(ch);
 }
 
-inline bool isEol(char ch) {
+constexpr bool isEol(char ch) {
     return ch == '\n' || ch == '\r';
 }
 
-inline bool isSpace(char ch) {
+constexpr bool isSpace(char ch) {
     return ch == ' ' || ch == '\t' || isEol(ch);
 }
 
+struct Step {
+    int state; // negative if the token can not continue
+    bool over;
+};
+
+// finite forms of every kind of token, shared by the token classes and the compile-time specs
+
+constexpr Step idStep(int state, char ch) {
+    if (state == 0) return {isHead(ch) ? 1 : -1, false};
+    return {1, !isBody(ch)};
+}
+
+constexpr Step numberStep(int state, char ch) {
+    bool const match = isDigit(ch) || ch == '.';
+    if (state == 0 && !match) return {-1, false};
+    return {1, state > 0 && !match};
+}
+
+constexpr Step strRegionStep(std::string_view head, std::string_view tail, int state, char ch) {
+    int const width = static_cast<int>(tail.size()) + 1;
+    int const size = std::min(state / width + 1, static_cast<int>(std::max<size_t>(head.size(), 2)) + 1);
+    int const done = state % width; // length of the longest suffix before ch that is a prefix of tail
+    bool const match = size > static_cast<int>(head.size()) || ch == head[size - 1];
+    bool const over = size > 2 && done == static_cast<int>(tail.size());
+    if (!match && !over) return {-1, false};
+    // the longest prefix of tail that the seen part of it followed by ch ends with
+    auto next = std::min<size_t>(done + 1, tail.size());
+    while (next > 0 && !(tail[next - 1] == ch && tail.substr(0, done).ends_with(tail.substr(0, next - 1)))) {
+        --next;
+    }
+    return {size * width + static_cast<int>(next), over};
+}
+
+constexpr Step charRegionStep(char left, char right, int state, char ch) {
+    int const size = std::min((state >> 1) + 1, 3);
+    bool const over = size > 2 && (state & 1);
+    if (size == 1 && ch != left) return {-1, false};
+    return {size << 1 | int(ch == right), over};
+}
+
+constexpr Step strFixedStep(std::string_view name, int state, char ch) {
+    auto const size = size_t(state) + 1;
+    bool const over = size == name.size() + 1;
+    if (!over && !(size <= name.size() && ch == name[size - 1])) return {-1, false};
+    return {state + 1, over};
+}
+
+constexpr Step charFixedStep(char name, int state, char ch) {
+    int const size = std::min(state + 1, 3);
+    bool const over = size == 2;
+    if (ch != name && !over) return {-1, false};
+    return {size, over};
+}
+
 struct Base {
     Base(Kind kind) : kind(kind) {}
     Kind kind;
@@ -36,6 +97,8 @@ struct Base {
     virtual bool match(std::string_view const &view) = 0;
     // suppose all characters of the view have matched, so check is not matched yet
     virtual bool over(std::string_view const &view) = 0;
+    // finite form of match/over used to build the dfa, state 0 is the empty view
+    virtual Step step(int state, char ch) const = 0;
 };
 
 struct Id : Base {
@@ -43,6 +106,7 @@ struct Id : Base {
      std::string show() const override { return "id"; }
     bool match(std::string_view const &view) override { return (view.size() == 1 ? isHead : isBody)(view.back()); }
     bool over(std::string_view const &view) override { return view.size() > 1 && !isBody(view.back()); }
+    Step step(int state, char ch) const override { return idStep(state, ch); }
 };
 
 struct Number : Base {
@@ -50,6 +114,7 @@ struct Number : Base {
      std::string show() const override { return "num"; }
     bool match(std::string_view const &view) override { return isDigit(view.back()) || view.back() == '.'; }
     bool over(std::string_view const &view) override { return view.size() > 1 && !match(view); }
+    Step step(int state, char ch) const override { return numberStep(state, ch); }
 };
 
 struct StrRegion : Base {
@@ -62,6 +127,7 @@ struct StrRegion : Base {
     bool over(std::string_view const &view) override {
         return view.size() > 2 && view.substr(0, view.size() - 1).ends_with(tail);
     }
+    Step step(int state, char ch) const override { return strRegionStep(head, tail, state, ch); }
     std::string const head, tail;
 };
 
@@ -70,6 +136,7 @@ struct CharRegion : Base {
      std::string show() const override { return std::format("{}...{}", left, right); }
     bool match(std::string_view const &view) override { return view.size() > 1 || view.front() == left; }
     bool over(std::string_view const &view) override { return view.size() > 2 && *(view.rbegin() + 1) == right; }
+    Step step(int state, char ch) const override { return charRegionStep(left, right, state, ch); }
     char const left;
     char const right;
 };
@@ -82,6 +149,7 @@ struct StrFixed : Base {
         return size < name.size() && view.back() == name[size];
     }
     bool over(std::string_view const &view) override { return view.size() == name.size() + 1; }
+    Step step(int state, char ch) const override { return strFixedStep(name, state, ch); }
     std::string const name;
 };
 
@@ -90,6 +158,7 @@ struct CharFixed : Base {
      std::string show() const override { return {name}; }
     bool match(std::string_view const &view) override { return view.back() == name; }
     bool over(std::string_view const &view) override { return view.size() == 2; }
+    Step step(int state, char ch) const override { return charFixedStep(name, state, ch); }
     char const name;
 };
 
@@ -98,28 +167,223 @@ struct Any : Base {
      std::string show() const override { return "any"; }
     bool match(std::string_view const &view) override { return !isSpace(view.back()); }
     bool over(std::string_view const &view) override { return view.size() > 1 && isSpace(view.back()); }
+    Step step(int state, char ch) const override {
+        if (state == 0) return {isSpace(ch) ? -1 : 1, false};
+        return {1, isSpace(ch)};
+    }
+};
+
+// every token of a list compiled into one table, keeping the filtering lexer's greedy match and list order priority
+class Dfa {
+public:
+    Dfa(std::vector<std::shared_ptr<Base>> const &tokens);
+
+    static constexpr int32_t reject = -1;
+
+    // next state if not negative, otherwise reject or an accepted kind ending before ch
+    int32_t next(int32_t state, char ch) const { return _table[state * _width + _classes[uint8_t(ch)]]; }
+    static bool accepted(int32_t action) { return action < reject; }
+    static Kind kind(int32_t action) { return uint16_t(reject - 1 - action); }
+    size_t states() const { return _table.size() / _width; }
+
+    // whitespace is dropped one character at a time from the start state
+    bool skipsSpace() const { return _skipsSpace; }
+    // skip the characters the state loops on with the scan kernels
+    char const *skip(int32_t state, char const *begin, char const *end) const {
+        switch (_loops[state].cls) {
+        case Loop::Body: return scan::body(begin, end);
+        case Loop::Number: return scan::number(begin, end);
+        case Loop::Until: return scan::until(begin, end, _loops[state].until);
+        default: return begin;
+        }
+    }
+
+private:
+    struct Loop {
+        enum Class : uint8_t { None, Body, Number, Until } cls{};
+        char until{};
+    };
+
+    std::array<uint8_t, 256> _classes{};
+    std::vector<Loop> _loops;
+    bool _skipsSpace{};
+    uint32_t _width{};
+    std::vector<int32_t> _table;
+};
+
+// tokens described by types, so a token list can be resolved at compile time
+namespace spec {
+
+template <StringLiteral Name, Kind::Value K> struct Fixed {
+    static constexpr Kind::Value kind = K;
+    static constexpr std::string_view name{Name.value, sizeof Name.value - 1};
+    static constexpr Step step(int state, char ch) { return strFixedStep(name, state, ch); }
+    static std::shared_ptr<Base> make() { return std::make_shared<StrFixed>(std::string(name), kind); }
+};
+
+template <char Name, Kind::Value K> struct Char {
+    static constexpr Kind::Value kind = K;
+    static constexpr Step step(int state, char ch) { return charFixedStep(Name, state, ch); }
+    static std::shared_ptr<Base> make() { return std::make_shared<CharFixed>(Name, kind); }
+};
+
+template <StringLiteral Head, StringLiteral Tail, Kind::Value K> struct Region {
+    static constexpr Kind::Value kind = K;
+    static constexpr std::string_view head{Head.value, sizeof Head.value - 1};
+    static constexpr std::string_view tail{Tail.value, sizeof Tail.value - 1};
+    static constexpr Step step(int state, char ch) { return strRegionStep(head, tail, state, ch); }
+    static std::shared_ptr<Base> make() { return std::make_shared<StrRegion>(std::string(head), std::string(tail), kind); }
+};
+
+template <char Left, char Right, Kind::Value K> struct CharRegion {
+    static constexpr Kind::Value kind = K;
+    static constexpr Step step(int state, char ch) { return charRegionStep(Left, Right, state, ch); }
+    static std::shared_ptr<Base> make() { return std::make_shared<token::CharRegion>(Left, Right, kind); }
+};
+
+template <Kind::Value K> struct Id {
+    static constexpr Kind::Value kind = K;
+    static constexpr Step step(int state, char ch) { return idStep(state, ch); }
+    static std::shared_ptr<Base> make() { return std::make_shared<token::Id>(kind); }
+};
+
+template <Kind::Value K> struct Number {
+    static constexpr Kind::Value kind = K;
+    static constexpr Step step(int state, char ch) { return numberStep(state, ch); }
+    static std::shared_ptr<Base> make() { return std::make_shared<token::Number>(kind); }
+};
+
+} // namespace spec
+
+// a token list compiled into a lexer of its own, with the same matching rules as the dfa
+// the first byte selects a function that steps only the specs starting with it, all inlined
+template <typename... Specs> class Static {
+public:
+    // action as the dfa's for a finished token or a reject, 0 if the input ended inside the token
+    struct Match {
+        int32_t action;
+        uint32_t length; // up to the end of the token, or up to the rejected character
+    };
+
+    static constexpr bool skipsSpace = (... && (Specs::step(0, ' ').state < 0 && Specs::step(0, '\t').state < 0 &&
+                                                 Specs::step(0, '\n').state < 0 && Specs::step(0, '\r').state < 0));
+
+    // begin < end, and *end is readable
+    static Match match(char const *begin, char const *end) { return _dispatch[uint8_t(*begin)](begin, end); }
+
+    // the same list for the table driven and the filtering lexers
+    static std::vector<std::shared_ptr<Base>> symbols() { return {Specs::make()...}; }
+
+private:
+    using Function = Match (*)(char const *, char const *);
+    template <size_t I> using Spec = std::tuple_element_t<I, std::tuple<Specs...>>;
+
+    // indices of the specs that accept b as their first character, in list order
+    template <uint8_t B> static constexpr auto _candidates = [] {
+        std::array<size_t, (... + size_t(Specs::step(0, char(B)).state >= 0))> res{};
+        size_t n{}, i{};
+        (..., (Specs::step(0, char(B)).state >= 0 ? void(res[n++] = i++) : void(i++)));
+        return res;
+    }();
+
+    template <typename S> static void _step(int &state, char ch, int32_t &first, bool &over) {
+        auto const step = S::step(state, ch);
+        state = step.state;
+        if (state < 0) return;
+        if (first == Dfa::reject) first = Dfa::reject - 1 - S::kind;
+        over = over && step.over;
+    }
+
+    template <uint8_t B> static Match _match(char const *begin, char const *end) {
+        constexpr auto &ids = _candidates<B>;
+        return [&]<size_t... J>(std::index_sequence<J...>) -> Match {
+            if constexpr (sizeof...(J) == 0) {
+                return {Dfa::reject, 0};
+            } else {
+                std::array<int, sizeof...(J)> states{Spec<ids[J]>::step(0, char(B)).state...};
+                for (auto const *pos = begin + 1;; ++pos) {
+                    int32_t first = Dfa::reject;
+                    bool over = true;
+                    (..., (states[J] >= 0 ? _step<Spec<ids[J]>>(states[J], *pos, first, over) : void()));
+                    auto const length = static_cast<uint32_t>(pos - begin);
+                    if (first == Dfa::reject || over) return {first, length};
+                    if (pos == end) return {0, length};
+                }
+            }
+        }(std::make_index_sequence<ids.size()>{});
+    }
+
+    static constexpr auto _dispatch = []<size_t... B>(std::index_sequence<B...>) {
+        return std::array<Function, 256>{&_match<uint8_t(B)>...};
+    }(std::make_index_sequence<256>{});
 };
 
 } // namespace token
 
 class Lexer {
 public:
-    Lexer(std::string const &str) : _string(str) {}
+    // the character after the end of str must be readable, a '\0' sentinel finishes the last token
+    // str must be valid utf-8, see scan::utf8
+    Lexer(std::string_view str) : _string(str) {}
 
      bool empty() const { return _returnedEof > 1; }
+    // continue from an offset where the lexer was between tokens
+    void seek(uint32_t offset) {
+        _begin = _now = offset;
+        _returnedEof = 0;
+    }
 
+    node::Token next(token::Dfa const &dfa);
+    template <typename... Specs> node::Token next(token::Static<Specs...> const &);
+    // every token up to the eof, lexed speculatively in chunks on several threads if jobs > 1
+    static std::vector<node::Token> lexAll(std::string_view str, token::Dfa const &dfa, unsigned jobs = 1);
+    // undefined input is collected instead of printed, report it later with printUndefined
+    void collectRejects(std::vector<std::string_view> *rejected) { _rejected = rejected; }
+    static void printUndefined(std::string_view view);
+    // false, after reporting it, if the eof carries the rest of a token the input ended in, an unterminated region
+    static bool finished(node::Token const &eof);
+    // filtering lexer, kept to cross check the dfa
     node::Token next(std::vector<std::shared_ptr<token::Base>> const &tokens);
 
 private:
      char _getNow() const { return _string[_now]; }
      char _getBegin() const { return _string[_begin]; }
      int _offset() const { return static_cast<int>(_now - _begin); }
-     std::string_view _view(uint32_t offset = 1) const {
-        return {_string.begin() + _begin, _string.begin() + _now + offset};
-    }
+     std::string_view _view(uint32_t offset = 1) const { return {_string.data() + _begin, _now + offset - _begin}; }
+    void _undefined(std::string_view view);
+    static std::vector<node::Token> _lexChunks(std::string_view str, token::Dfa const &dfa, unsigned jobs);
 
 private:
     uint32_t _begin{}, _now{};
-    std::string const &_string;
+    std::string_view const _string;
     int _returnedEof{};
+    std::vector<std::string_view> *_rejected{}; // collected instead of printed when set
 };
+
+template <typename... Specs> node::Token Lexer::next(token::Static<Specs...> const &) {
+    using Lexicon = token::Static<Specs...>;
+    auto const *const data = _string.data();
+    for (;;) {
+        if (Lexicon::skipsSpace && _begin == _now) {
+            _begin = _now = static_cast<uint32_t>(scan::spaces(data + _now, data + _string.length()) - data);
+        }
+        if (_now == _string.length()) break;
+        auto const [action, length] = Lexicon::match(data + _now, data + _string.length());
+        _now += length;
+        if (token::Dfa::accepted(action)) {
+            auto v = _view(0);
+            _begin = _now;
+            return {token::Dfa::kind(action), v};
+        }
+        if (action != token::Dfa::reject) break; // the eof keeps the unfinished token
+        if (_now == _string.length()) {
+            _undefined(_view(0));
+            _begin = _now;
+            break;
+        }
+        _undefined(_view());
+        _begin = ++_now;
+    }
+    ++_returnedEof;
+    return {Kind::Eof, _view(0)};
+}
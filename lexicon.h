@@ -0,0 +1,147 @@
+#pragma once
+#include "lexer.h"
+
+// the token lists of simpl and of its grammar file, each compiled into its own lexer
+namespace lexicon {
+
+using namespace token::spec;
+
+using Simpl = token::Static<
+    Fixed<"module", Kind::Module>,
+    Fixed<"false", Kind::Bool>,
+    Fixed<"true", Kind::Bool>,
+    CharRegion<'\'', '\'', Kind::Apostrophe>,
+    CharRegion<'"', '"', Kind::Quotation>,
+    Char<'=', Kind::SingleEqual>,
+    Fixed<"==", Kind::DoubleEqual>,
+    Fixed<"!=", Kind::ExclamationEqual>,
+    Char<':', Kind::SingleColon>,
+    Fixed<"::", Kind::DoubleColon>,
+    Char<'(', Kind::OpenParenthesis>,
+    Char<')', Kind::CloseParenthesis>,
+    Char<'[', Kind::OpenSquareBracket>,
+    Char<']', Kind::CloseSquareBracket>,
+    Char<'{', Kind::OpenCurlyBracket>,
+    Char<'}', Kind::CloseCurlyBracket>,
+    Char<'<', Kind::LessThan>,
+    Char<'>', Kind::GreatThan>,
+    Fixed<"<=", Kind::LessThanOrEqual>,
+    Fixed<">=", Kind::GreatThanOrEqual>,
+    Char<'&', Kind::SingleAnd>,
+    Fixed<"&&", Kind::DoubleAnd>,
+    Char<'|', Kind::SingleOr>,
+    Fixed<"||", Kind::DoubleOr>,
+    Char<'+', Kind::SinglePlus>,
+    // Fixed<"++", Kind::DoublePlus>,
+    Char<'-', Kind::SingleMinus>,
+    // Fixed<"--", Kind::DoubleMinus>,
+    Char<'*', Kind::SingleAsterisk>,
+    Fixed<"**", Kind::DoubleAsterisk>,
+    Char<'/', Kind::SingleSlash>,
+    Fixed<"//", Kind::DoubleSlash>,
+    Char<'%', Kind::Percent>,
+    Char<'.', Kind::Dot>,
+    Char<',', Kind::Comma>,
+    Char<';', Kind::Semicolon>,
+    Char<'!', Kind::Exclamation>,
+    Char<'?', Kind::Question>,
+    Char<'#', Kind::Hash>,
+    Fixed<"<=>", Kind::Spaceship>,
+    Id<Kind::Id>,
+    Number<Kind::Number>,
+    Region<"//", "\n", Kind::Comment>,
+    Region<"--", "\n", Kind::Comment>,
+    Region<"/*", "*/", Kind::Comment>>;
+
+using Bnf = token::Static<
+    CharRegion<'`', '`', Kind::GEpsilon>,
+    Fixed<"::=", Kind::BnfEqual>,
+    Fixed<"<+>", Kind::ChevronsOr>,
+    Fixed<"<$>", Kind::ChevronsEnd>,
+    Char<'=', Kind::SingleEqual>,
+    Fixed<"==", Kind::DoubleEqual>,
+    Fixed<"!=", Kind::ExclamationEqual>,
+    Char<':', Kind::SingleColon>,
+    Fixed<"::", Kind::DoubleColon>,
+    Char<'(', Kind::OpenParenthesis>,
+    Char<')', Kind::CloseParenthesis>,
+    Char<'[', Kind::OpenSquareBracket>,
+    Char<']', Kind::CloseSquareBracket>,
+    Char<'{', Kind::OpenCurlyBracket>,
+    Char<'}', Kind::CloseCurlyBracket>,
+    Char<'<', Kind::LessThan>,
+    Char<'>', Kind::GreatThan>,
+    Fixed<"<=", Kind::LessThanOrEqual>,
+    Fixed<">=", Kind::GreatThanOrEqual>,
+    Char<'&', Kind::SingleAnd>,
+    Fixed<"&&", Kind::DoubleAnd>,
+    Char<'|', Kind::SingleOr>,
+    Fixed<"||", Kind::DoubleOr>,
+    Char<'+', Kind::SinglePlus>,
+    Fixed<"++", Kind::DoublePlus>,
+    Char<'-', Kind::SingleMinus>,
+    Fixed<"--", Kind::DoubleMinus>,
+    Char<'*', Kind::SingleAsterisk>,
+    Fixed<"**", Kind::DoubleAsterisk>,
+    Char<'/', Kind::SingleSlash>,
+    Fixed<"//", Kind::DoubleSlash>,
+    Char<'%', Kind::Percent>,
+    Char<'.', Kind::Dot>,
+    Char<',', Kind::Comma>,
+    Char<';', Kind::Semicolon>,
+    Char<'!', Kind::Exclamation>,
+    Char<'?', Kind::Question>,
+    Char<'#', Kind::Hash>,
+    Fixed<"<=>", Kind::Spaceship>,
+    Fixed<"module", Kind::Module>,
+    Fixed<"Root", Kind::Root>,
+    Fixed<"epsilon", Kind::epsilon>,
+    Fixed<"Stmt", Kind::Stmt>,
+    Fixed<"Stmt'", Kind::Stm_>,
+    Fixed<"Expr", Kind::Expr>,
+    Fixed<"Expr'", Kind::Exp_>,
+    Fixed<"Fact", Kind::Fact>,
+    Fixed<"Fact'", Kind::Fac_>,
+    Fixed<"Unary", Kind::Unary>,
+    Fixed<"Binary", Kind::Binary>,
+    Fixed<"LtoR", Kind::LtoR>,
+    Fixed<"RtoL", Kind::RtoL>,
+    Fixed<"Number", Kind::Number>,
+    Fixed<"Id", Kind::Id>,
+    Fixed<"Atom", Kind::Atom>,
+    Fixed<"IModule", Kind::IModule>,
+    Fixed<"Set", Kind::Set>,
+    Fixed<"Extract", Kind::Extract>,
+    Fixed<"Annot", Kind::Annot>,
+    Fixed<"Bool", Kind::Bool>,
+    Fixed<"Op1", Kind::Op1>,
+    Fixed<"Op2", Kind::Op2>,
+    Fixed<"Op3", Kind::Op3>,
+    Fixed<"Op4", Kind::Op4>,
+    Fixed<"Op5", Kind::Op5>,
+    Fixed<"Op6", Kind::Op6>,
+    Fixed<"Op7", Kind::Op7>,
+    Fixed<"Op8", Kind::Op8>,
+    Fixed<"Op9", Kind::Op9>,
+    Fixed<"Exp1", Kind::Exp1>,
+    Fixed<"Exp2", Kind::Exp2>,
+    Fixed<"Exp3", Kind::Exp3>,
+    Fixed<"Exp4", Kind::Exp4>,
+    Fixed<"Exp5", Kind::Exp5>,
+    Fixed<"Exp6", Kind::Exp6>,
+    Fixed<"Exp7", Kind::Exp7>,
+    Fixed<"Exp8", Kind::Exp8>,
+    Fixed<"Exp9", Kind::Exp9>,
+    Fixed<"Exp1'", Kind::Exp1_>,
+    Fixed<"Exp2'", Kind::Exp2_>,
+    Fixed<"Exp3'", Kind::Exp3_>,
+    Fixed<"Exp4'", Kind::Exp4_>,
+    Fixed<"Exp5'", Kind::Exp5_>,
+    Fixed<"Exp6'", Kind::Exp6_>,
+    Fixed<"Exp7'", Kind::Exp7_>,
+    Fixed<"Exp8'", Kind::Exp8_>,
+    Fixed<"Exp9'", Kind::Exp9_>,
+    Fixed<"Super", Kind::Super>,
+    Fixed<"Params", Kind::Params>>;
+
+} // namespace lexicon
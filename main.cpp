@@ -1,253 +1,254 @@
+#include "ast.h"
+#include "bench.h"
+#include "buildid.h"
 #include "cfg.h"
-#include "lexer.h"
+#include "descent.h"
+#include "lexicon.h"
 #include "outs.h"
 #include "parser.h"
+#include "pipeline.h"
+#include "source.h"
+#include "tokens.h"
+
+struct Options {
+    char const *filename{};
+    bool crosscheck{}; // lex with the filtering lexer as well and compare
+    bool benchLex{};
+    bool benchParallel{};
+    bool benchParse{};
+    bool benchFrontend{};
+    bool checkDescent{};
+    bool checkRelex{};
+    bool benchIncremental{};
+    bool pipeline{}; // lex on a second thread while parsing
+    bool prelex{}; // lex the whole input before parsing
+    bool direct{}; // build the ast while parsing, without a cst
+    bool descent{}; // parse with the generated recursive descent parser, implies prelex
+    unsigned jobs{1}; // threads lexing and parsing the input, implies prelex
+    bool cache{true}; // keep the digested ast of the input next to it, for a later run of the same text
+
+    // an option picking how the input is lexed or parsed always runs that front end, the cache is only refreshed
+    bool frontend() const { return crosscheck || pipeline || prelex || direct || descent || jobs > 1; }
+};
+
+// lexes and parses the input with the front end opts pick, its statements into ast, none after errors
+std::optional<node::Ref> parse(Options const &opts, SourceManager const &sources, std::string_view str, node::Ast &ast) {
+    auto const &bnf = LangCFG::getSymbols();
+    token::Dfa const dfa(bnf);
 
-std::unique_ptr<node::Token> genAst(node::Nonterm &self, Context &ctx) {
-    auto get = [&self](auto idx) { return self.args[self.size - 1 - idx].get(); };
-    auto nonterm = [&get](auto idx) -> node::Nonterm & { return get(idx)->template cast<node::Nonterm>(); };
-
-    switch (self.kind.value()) {
-
-    case Kind::Root: return genAst(nonterm(0), ctx);
-
-    case Kind::Stmt: {
-        if (auto stmt = genAst(nonterm(1), ctx)) {
-            stmt->cast<node::Statements>().pushFront(genAst(nonterm(0), ctx));
-            return stmt;
-        }
-        auto stmt = std::make_unique<node::Statements>(genAst(nonterm(0), ctx));
-        return stmt;
-    }
+    Parser parser;
+    LangCFG::setup(parser);
+    if (opts.direct) parser.setReduce(reduceInto(ast));
+    // setVerbosity(Verbosity::Diagnostic);
 
-    case Kind::Stm_: {
-        if (get(0)->kind == Kind::epsilon) return nullptr;
-        if (auto stmt = genAst(nonterm(2), ctx)) {
-            stmt->cast<node::Statements>().pushFront(genAst(nonterm(1), ctx));
-            return stmt;
-        }
-        return std::make_unique<node::Statements>(genAst(nonterm(1), ctx));
+    parser.setSources(sources);
+    if (auto const *bad = scan::utf8(str.data(), str.data() + str.size()); bad != str.data() + str.size()) {
+        Quiet<style::red>(), "invalid utf-8\n";
+        Node({bad, 1}).printCode(sources);
+        return {};
     }
 
-    case Kind::Fact:
-        switch (get(0)->kind.value()) {
-        case Kind::Id: {
-            auto lvalue = genAst(nonterm(0), ctx);
-            if (auto annot = genAst(nonterm(1), ctx)) {
-                lvalue->cast<node::Set>().setSuperset(std::move(annot));
-            }
-            return std::make_unique<node::Fact>(std::move(lvalue), genAst(nonterm(2), ctx));
-        }
-        case Kind::Module: {
-            auto module = std::make_unique<node::Module>(
-                genAst(nonterm(3), ctx), get(0)->combine(*get(4)), std::string(nonterm(1).view)
-            );
-            return module;
-        }
-        default: return nullptr;
-        }
-
-    case Kind::Fac_: return get(0)->kind == Kind::epsilon ? nullptr : genAst(nonterm(1), ctx);
-
-    case Kind::Exp1:
-        switch (get(0)->kind.value()) {
-        case Kind::RtoL: {
-            auto lexp = genAst(nonterm(0), ctx);
-            lexp->cast<node::Unary>().setParam(genAst(nonterm(1), ctx));
-            return lexp;
+    Lexer lexer(str), checker(str), compiled(str);
+    auto const lex = [&] {
+        auto next = lexer.next(dfa);
+        if (opts.crosscheck) {
+            auto const check = [&](std::string_view name, node::Token const &other) {
+                if (other.kind != next.kind || other.view != next.view) {
+                    Quiet<style::red>(), "dfa lexed ", next.kind.name(), " '", next.view, "' but ", name, " lexed ";
+                    Quiet<style::red>(), other.kind.name(), " '", other.view, "'\n";
+                    other.printCode(sources);
+                }
+            };
+            check("filter", checker.next(bnf));
+            check("static", compiled.next(lexicon::Simpl{}));
         }
-        case Kind::Id: {
-            auto id = genAst(nonterm(0), ctx);
-            auto params = genAst(nonterm(1), ctx);
-            auto super = genAst(nonterm(2), ctx);
-            id->cast<node::Set>().setParams(std::move(params));
-            return std::make_unique<node::Expression>(std::move(id), std::move(super));
-        }
-        case Kind::OpenParenthesis: return genAst(nonterm(1), ctx);
-        case Kind::OpenCurlyBracket: return std::make_unique<node::Void>(nonterm(0).combine(*get(1)));
-        default: return genAst(nonterm(0), ctx);
+        return next;
+    };
+    int syntaxErr{};
+    bool finished = true; // the input did not end in the middle of a token
+    std::optional<TokenStream> prelexed;
+    std::optional<Descent> descent;
+    node::Token *descended{};
+    node::Ref parallel; // the statements, when the input was parsed on several threads
+    auto const parse = [&](node::Token const &next) {
+        Diagn(), "== ", next.kind.name(), " ", next.view, " ==\n";
+        syntaxErr += parser.parse(next);
+    };
+
+    if (opts.descent) {
+        finished = prelexed.emplace(str, dfa, opts.jobs).finished();
+        descended = descent.emplace(*prelexed, &sources).parse();
+        syntaxErr = descent->errors();
+    } else if (opts.pipeline) {
+        syntaxErr = parsePipelined(parser, str, dfa, finished);
+    } else if (opts.prelex || opts.jobs > 1) {
+        auto const &stream = prelexed.emplace(str, dfa, opts.jobs);
+        finished = stream.finished();
+        if (opts.jobs > 1 && finished) parallel = parseParallel(parser, stream, opts.jobs, ast);
+        for (uint32_t i = 0; !parallel && i < stream.size(); ++i) {
+            Diagn(), "== ", stream.kind(i).name(), " ", stream.view(i), " ==\n";
+            syntaxErr += parser.parse(stream, i);
         }
-
-    case Kind::Exp2:
-    case Kind::Exp3:
-    case Kind::Exp4:
-    case Kind::Exp5:
-    case Kind::Exp6: {
-        auto l = genAst(nonterm(0), ctx);
-        auto r = genAst(nonterm(1), ctx);
-        if (r) {
-            auto &binary = r->cast<node::Binary>();
-            binary.setLhs(std::move(l));
-            return r;
+    } else {
+        for (auto next = lex(); !lexer.empty(); next = lex()) {
+            parse(next);
+            if (next.kind == Kind::Eof) finished = Lexer::finished(next);
         }
-        return l;
     }
 
-    case Kind::Exp2_:
-    case Kind::Exp3_:
-    case Kind::Exp4_:
-    case Kind::Exp5_:
-    case Kind::Exp6_: {
-        if (get(0)->kind == Kind::epsilon) return nullptr;
-        auto left = genAst(nonterm(0), ctx);
-        auto expr = genAst(nonterm(1), ctx);
-        auto right = genAst(nonterm(2), ctx);
-        if (!right) {
-            left->cast<node::Binary>().setRhs(std::move(expr));
-            return left;
-        }
-        left->cast<node::Binary>().setRhs(std::move(expr));
-        right->cast<node::Binary>().setLhs(std::move(left));
-        return right;
+    if (syntaxErr >= 1) {
+        Quiet<style::red>(), syntaxErr, " syntax error", syntaxErr == 1 ? "\n" : "s\n";
+        return {};
+    }
+    if (!finished) return {};
+
+    auto const stmts = parallel       ? parallel
+                       : opts.direct  ? parser.getValues().front().ast
+                       : opts.descent ? genAst(ast, descended->cast<node::Nonterm>())
+                                      : genAst(ast, parser.getCst().front()->cast<node::Nonterm>());
+    parser.restart(); // the ast copied what it needs, the cst goes all at once
+
+    if (auto const overflow = ast.overflow()) {
+        Quiet<style::red>(), "more than ", size_t{node::maxIndex} + 1, " nodes of a kind\n";
+        sources.print(*overflow);
+        return {};
     }
 
-    case Kind::RtoL: return std::make_unique<node::Unary>(*get(0));
-
-    case Kind::Op2:
-    case Kind::Op3:
-    case Kind::Op4:
-    case Kind::Op5:
-    case Kind::Op6: return std::make_unique<node::Binary>(*get(0));
-
-    case Kind::Super:
-        switch (get(0)->kind.value()) {
-        case Kind::epsilon: return nullptr;
-        case Kind::SingleColon: {
-            auto extract = genAst(nonterm(1), ctx);
-            auto params = genAst(nonterm(2), ctx);
-            auto super = genAst(nonterm(3), ctx);
-            extract->cast<node::Set>().setParams(std::move(params));
-            return std::make_unique<node::Expression>(std::move(extract), std::move(super));
+    for (auto const &[number, ec] : ast.badNumbers()) {
+        if (ec == std::errc::result_out_of_range) {
+            Quiet<style::red>(), "number '", number, "' out of range\n";
+        } else {
+            Quiet<style::red>(), "malformed number '", number, "'\n";
         }
-        }
-
-    case Kind::Params:
-    case Kind::Annot: return get(0)->kind == Kind::epsilon ? nullptr : genAst(nonterm(1), ctx);
-
-    case Kind::Id: return std::make_unique<node::Set>(self.view);
-
-    case Kind::Bool: return std::make_unique<node::Bool>(self);
-
-    case Kind::Number: return std::make_unique<node::Int>(self);
-
-    default: return nullptr;
+        sources.print(number);
+    }
+    for (auto const module : ast.misplacedModules()) {
+        Quiet<style::red>(), "module among the parameters of a set, which only takes facts\n";
+        sources.print(module);
     }
+    if (!ast.badNumbers().empty() || !ast.misplacedModules().empty()) return {};
+    return stmts;
 }
 
-void run(char const *filename) {
-    auto const bnf = [] {
-        using namespace token;
-        return std::vector<std::shared_ptr<Base>>{
-            std::make_shared<StrFixed>("module", Kind::Module),
-            std::make_shared<StrFixed>("false", Kind::Bool),
-            std::make_shared<StrFixed>("true", Kind::Bool),
-            std::make_shared<CharRegion>('\'', '\'', Kind::Apostrophe),
-            std::make_shared<CharRegion>('"', '"', Kind::Quotation),
-            std::make_shared<CharFixed>('=', Kind::SingleEqual),
-            std::make_shared<StrFixed>("==", Kind::DoubleEqual),
-            std::make_shared<StrFixed>("!=", Kind::ExclamationEqual),
-            std::make_shared<CharFixed>(':', Kind::SingleColon),
-            std::make_shared<StrFixed>("::", Kind::DoubleColon),
-            std::make_shared<CharFixed>('(', Kind::OpenParenthesis),
-            std::make_shared<CharFixed>(')', Kind::CloseParenthesis),
-            std::make_shared<CharFixed>('[', Kind::OpenSquareBracket),
-            std::make_shared<CharFixed>(']', Kind::CloseSquareBracket),
-            std::make_shared<CharFixed>('{', Kind::OpenCurlyBracket),
-            std::make_shared<CharFixed>('}', Kind::CloseCurlyBracket),
-            std::make_shared<CharFixed>('<', Kind::LessThan),
-            std::make_shared<CharFixed>('>', Kind::GreatThan),
-            std::make_shared<StrFixed>("<=", Kind::LessThanOrEqual),
-            std::make_shared<StrFixed>(">=", Kind::GreatThanOrEqual),
-            std::make_shared<CharFixed>('&', Kind::SingleAnd),
-            std::make_shared<StrFixed>("&&", Kind::DoubleAnd),
-            std::make_shared<CharFixed>('|', Kind::SingleOr),
-            std::make_shared<StrFixed>("||", Kind::DoubleOr),
-            std::make_shared<CharFixed>('+', Kind::SinglePlus),
-            // std::make_shared<StrFixed>("++", Kind::DoublePlus),
-            std::make_shared<CharFixed>('-', Kind::SingleMinus),
-            // std::make_shared<StrFixed>("--", Kind::DoubleMinus),
-            std::make_shared<CharFixed>('*', Kind::SingleAsterisk),
-            std::make_shared<StrFixed>("**", Kind::DoubleAsterisk),
-            std::make_shared<CharFixed>('/', Kind::SingleSlash),
-            std::make_shared<StrFixed>("//", Kind::DoubleSlash),
-            std::make_shared<CharFixed>('%', Kind::Percent),
-            std::make_shared<CharFixed>('.', Kind::Dot),
-            std::make_shared<CharFixed>(',', Kind::Comma),
-            std::make_shared<CharFixed>(';', Kind::Semicolon),
-            std::make_shared<CharFixed>('!', Kind::Exclamation),
-            std::make_shared<CharFixed>('?', Kind::Question),
-            std::make_shared<CharFixed>('#', Kind::Hash),
-            std::make_shared<StrFixed>("<=>", Kind::Spaceship),
-            std::make_shared<Id>(Kind::Id),
-            std::make_shared<Number>(Kind::Number),
-            std::make_shared<StrRegion>("//", "\n", Kind::Comment),
-            std::make_shared<StrRegion>("--", "\n", Kind::Comment),
-            std::make_shared<StrRegion>("/*", "*/", Kind::Comment),
-        };
-    }();
-
+void run(Options const &opts) {
+    std::string const filename = opts.filename;
     setVerbosity(Verbosity::Quiet);
-    auto const cfg = LangCFG::getCFG();
-    // setVerbosity(Verbosity::Diagnostic);
-
-    Parser parser;
-    parser.setupGramma(cfg);
-
-    std::ifstream file(filename);
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    auto str = buffer.str() + ' ';
-    parser.setRawText(str);
-
-    Lexer lexer(str);
-    auto next = lexer.next(bnf);
-    int syntaxErr{};
-    for (; !lexer.empty(); next = lexer.next(bnf)) {
-        Diagn(), "== ", next.kind.name(), " ", next.view, " ==\n";
-        syntaxErr += parser.parse(next);
-    }
-
-    if (next.kind != Kind::Eof && next.view.length() > 1) {
-        Quiet<style::red>(), "lex error: rest is '", next.view;
-        return;
-    }
-
-    if (syntaxErr >= 1) {
-        Quiet<style::red>(), syntaxErr, " syntax error", syntaxErr == 1 ? "\n" : "s\n";
-        return;
+    SourceManager sources;
+    auto const str = sources.load(filename);
+    auto const modulename = filename2module(filename);
+
+    node::Ast ast;
+    Context ctx(sources);
+    std::array<node::Ref, 2> roots; // the module of the file and the main expression solved in it
+    auto const cache = filename + ".ast";
+    // the name of the module is taken from the file, the ast depends on it as much as on the text, and on the build
+    // that digested it
+    auto const key = fnv1a(str, fnv1a(modulename, fnv1a(buildId(), LangCFG::key())));
+    std::error_code ec;
+    bool const cached = opts.cache && !opts.frontend() && std::filesystem::exists(cache, ec) &&
+                        ast.load(Source(cache).view(), key, str, roots);
+    if (!cached) {
+        auto const reported = reports();
+        auto const stmts = parse(opts, sources, str, ast);
+        if (!stmts) return;
+
+        auto const root = ast.module(*stmts, modulename);
+        ctx.scope.push(root.index());
+        auto const super = ast.expression(ast.set(modulename), {});
+        auto const expr = ast.expression(ast.set("main"), super);
+
+        ast.digest(expr, ctx);
+        ast.digest(root, ctx);
+        ctx.scope.pop();
+        roots = {root, expr};
+        // an input with warnings is not cached, so they show up on every run
+        if (opts.cache && reports() == reported) {
+            if (auto const artifact = ast.save(key, str, roots); !artifact.empty()) replaceFile(cache, artifact);
+        }
     }
-
-    Context ctx(str);
-    auto ast = genAst(parser.getCst()._Get_container().front()->cast<node::Nonterm>(), ctx);
-
-    auto modulename = filename2module(filename);
-    auto root = node::Module(std::move(ast), {str}, modulename);
-    ctx.scope.push(&root);
+    auto const [root, expr] = roots;
+    ctx.scope.push(root.index());
     ctx.params.push(set::create<set::Sets>());
-    auto super = std::make_unique<node::Expression>(std::make_unique<node::Set>(modulename), nullptr);
-    auto expr = node::Expression(std::make_unique<node::Set>("main"), std::move(super));
-
-    expr.digest(ctx);
-    root.digest(ctx);
 
-    // root.dump();
+    // ast.dump(root);
     // std::cout << std::flush;
 
-    auto solved = expr.solve(ctx);
+    auto solved = ast.solve(expr, ctx);
 
     // compile to llvm ir here
 
     if (solved.ok()) {
         Quiet<style::blue>(), "> ", solved.show(), "\n";
     } else {
-        Quiet<style::blue>(), "> unsolved module '", root.getName(), "'\n";
+        Quiet<style::blue>(), "> unsolved module '", ast.name(root.index()), "'\n";
     }
 }
 
 #include <chrono>
 
 int main(int argc, char *argv[]) {
-    run(((void)argc, argv[1])); // NOLINT
+    Options opts;
+    for (auto const *arg : std::span(argv + 1, argc - 1)) {
+        if (std::string_view(arg) == "--crosscheck") {
+            opts.crosscheck = true;
+        } else if (std::string_view(arg) == "--bench-lex") {
+            opts.benchLex = true;
+        } else if (std::string_view(arg) == "--bench-parallel") {
+            opts.benchParallel = true;
+        } else if (std::string_view(arg) == "--bench-parse") {
+            opts.benchParse = true;
+        } else if (std::string_view(arg) == "--bench-startup") {
+            bench::startup();
+            return 0;
+        } else if (std::string_view(arg) == "--bench-incremental") {
+            opts.benchIncremental = true;
+        } else if (std::string_view(arg) == "--stress") {
+            bench::stress();
+            return 0;
+        } else if (std::string_view(arg) == "--bench-symbols") {
+            bench::symbols();
+            return 0;
+        } else if (std::string_view(arg) == "--bench-frontend") {
+            opts.benchFrontend = true;
+        } else if (std::string_view(arg) == "--check-descent") {
+            opts.checkDescent = true;
+        } else if (std::string_view(arg) == "--check-relex") {
+            opts.checkRelex = true;
+        } else if (std::string_view(arg) == "--pipeline") {
+            opts.pipeline = true;
+        } else if (std::string_view(arg) == "--direct") {
+            opts.direct = true;
+        } else if (std::string_view(arg) == "--descent") {
+            opts.descent = true;
+        } else if (std::string_view(arg) == "--prelex") {
+            opts.prelex = true;
+        } else if (std::string_view(arg) == "--no-cache") {
+            opts.cache = false;
+        } else if (std::string_view(arg).starts_with("--jobs=")) {
+            std::string_view const jobs(arg + 7);
+            auto const [end, ec] = std::from_chars(jobs.data(), jobs.data() + jobs.size(), opts.jobs);
+            if (ec != std::errc{} || end != jobs.data() + jobs.size() || opts.jobs == 0) {
+                Quiet<style::red>(), "invalid job count '", jobs, "'\n";
+                return 1;
+            }
+        } else {
+            opts.filename = arg;
+        }
+    }
+    if (opts.benchLex || opts.benchParallel || opts.benchParse || opts.benchFrontend || opts.benchIncremental ||
+        opts.checkDescent || opts.checkRelex) {
+        Source const source(opts.filename);
+        auto const bench = opts.benchLex           ? bench::lexer
+                           : opts.benchParallel    ? bench::parallel
+                           : opts.benchParse       ? bench::parser
+                           : opts.benchFrontend    ? bench::frontend
+                           : opts.benchIncremental ? bench::incremental
+                           : opts.checkRelex       ? bench::relex
+                                                   : bench::descent;
+        bench(std::string(source.view()));
+        return 0;
+    }
+    run(opts);
     std::vector<std::string> emoji = {"🥳", "😘", "😗", "😙", "😚"};
     auto idx = std::chrono::system_clock::now().time_since_epoch().count() % emoji.size();
     std::cout << emoji[idx] << '\n';
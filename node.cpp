@@ -3,6 +3,272 @@
 
 using namespace node;
 
+namespace {
+
+std::map<Kind, Symbol> const unaries{
+    {Kind::Exclamation, Symbol("Not")},
+    {Kind::SingleMinus, Symbol("Neg")},
+};
+
+std::map<Kind, Symbol> const binaries{
+    {      Kind::SinglePlus,   Symbol("Add")},
+    {     Kind::SingleMinus,   Symbol("Sub")},
+    {  Kind::SingleAsterisk,   Symbol("Mul")},
+    {     Kind::SingleSlash,   Symbol("Div")},
+    {        Kind::LessThan,    Symbol("Lt")},
+    {       Kind::GreatThan,    Symbol("Gt")},
+    { Kind::LessThanOrEqual,  Symbol("Lteq")},
+    {Kind::GreatThanOrEqual,  Symbol("Gteq")},
+    {     Kind::DoubleEqual,    Symbol("Eq")},
+    {Kind::ExclamationEqual, Symbol("Noteq")},
+    {     Kind::Exclamation,   Symbol("Not")},
+    {       Kind::DoubleAnd,   Symbol("And")},
+    {        Kind::DoubleOr,    Symbol("Or")},
+};
+
+std::string_view join(std::string_view head, std::string_view tail) {
+    return Node(head).combine(tail).view;
+}
+
+// the set of global named name, extracted once per context
+set::Set const &builtin(Context &ctx, Symbol name) {
+    auto it = ctx.builtins.find(name);
+    if (it == ctx.builtins.end()) {
+        it = ctx.builtins.emplace(name, ctx.global.extract(name)).first;
+    }
+    return it->second;
+}
+
+// what a resolved operator extracts, nothing while it is unsolved
+set::Set extracted(set::Set &&applied) {
+    return applied.ok() && applied.solved() ? std::move(applied) : set::create();
+}
+
+// false if from does not fit behind to, which then keeps the first node of from it has no room for as its overflow
+template <typename T> bool fits(Pool<T> &to, Pool<T> const &from) {
+    if (!to.overflow) to.overflow = from.overflow;
+    if (!to.overflow && to.hot.size() + from.hot.size() > size_t{maxIndex} + 1) {
+        to.overflow = from.spans[maxIndex + 1 - to.hot.size()];
+    }
+    return !to.overflow;
+}
+
+template <typename T> void concat(Pool<T> &to, Pool<T> const &from) {
+    to.hot.insert(to.hot.end(), from.hot.begin(), from.hot.end());
+    to.spans.insert(to.spans.end(), from.spans.begin(), from.spans.end());
+}
+
+// layout of a saved ast, followed by its roots, the nodes and then the spans of each pool, the lists, the constants,
+// the symbols and the names
+struct Artifact {
+    std::array<char, 8> magic;
+    uint64_t key, checksum; // of all that follows
+    uint32_t version, roots, lists, constants, symbols, names;
+    std::array<uint32_t, 9> pools; // the sizes, from the facts to the voids
+    uint32_t spare;                // zero
+};
+static_assert(sizeof(Artifact) == 88, "written as it is, padding included");
+constexpr std::array<char, 8> artifactMagic{'s', 'i', 'm', 'p', 'l', 'a', 's', 't'};
+// bumped whenever the layout changes, a build building or digesting differently has another build id
+constexpr uint32_t artifactVersion = 4;
+
+// a view as an offset into the text, or past its end into the names
+struct View {
+    uint32_t offset, size;
+};
+
+// the nodes holding symbols, views or kinds as they are saved, without padding
+// a symbol is saved as its index among the symbols of the artifact, ids are only valid in one process
+struct ModuleRecord {
+    uint32_t name;
+    Range facts, modules;
+};
+
+struct SetRecord {
+    uint32_t name;
+    Ref annotation;
+    uint32_t ref;
+    Range params, facts;
+};
+
+struct UnaryRecord {
+    uint32_t op;
+    Ref operand;
+};
+
+struct BinaryRecord {
+    uint32_t op;
+    Ref lhs, rhs;
+    uint32_t ref;
+};
+
+// what a node of each pool takes saved, its span aside
+constexpr std::array<size_t, 9> recordSizes{sizeof(Fact),         sizeof(ModuleRecord), sizeof(SetRecord),
+                                            sizeof(Expression),   sizeof(UnaryRecord),  sizeof(BinaryRecord),
+                                            sizeof(Number),       sizeof(uint8_t),      0};
+// a constant is saved as the index of its alternative and its bits
+constexpr size_t constantSize = sizeof(uint8_t) + sizeof(uint64_t);
+
+size_t slot(Type type) {
+    return static_cast<size_t>(type) - static_cast<size_t>(Type::Fact);
+}
+
+// puts the pools together as they are saved, the symbols and the names out of the text behind them
+class Writer {
+public:
+    explicit Writer(std::string_view text) : _text(text) {}
+
+    uint32_t symbol(Symbol symbol) {
+        if (symbol.id() >= _indices.size()) _indices.resize(symbol.id() + 1, none);
+        auto &index = _indices[symbol.id()];
+        if (index == none) {
+            index = static_cast<uint32_t>(_symbols.size());
+            _symbols.push_back(symbol);
+        }
+        return index;
+    }
+
+    template <typename T> void put(T const &value) { _out.append(reinterpret_cast<char const *>(&value), sizeof value); }
+
+    // a view the nodes hold, one not into the text is a name the program was given from outside
+    View name(std::string_view view) {
+        if (auto const res = _into(view)) return *res;
+        auto const offset = static_cast<uint32_t>(_text.size() + _names.size());
+        auto const [it, fresh] = _offsets.try_emplace({view.data(), view.size()}, offset);
+        if (fresh) _names += view;
+        return {it->second, static_cast<uint32_t>(view.size())};
+    }
+
+    // the spans of sets are their names, those come first
+    void names(Pool<Set> const &sets) {
+        for (auto span : sets.spans) {
+            put(name(span));
+        }
+    }
+
+    // a span not into the text is one of the names, or joined across them and no place at all
+    template <typename T> void spans(Pool<T> const &pool) {
+        for (auto span : pool.spans) {
+            auto res = _into(span);
+            if (!res) {
+                auto const it = _offsets.find({span.data(), span.size()});
+                res = it != _offsets.end() ? View{it->second, static_cast<uint32_t>(span.size())} : View{};
+            }
+            put(*res);
+        }
+    }
+
+    std::string finish(Artifact head) {
+        for (auto symbol : _symbols) {
+            put(name(symbol.view()));
+        }
+        head.symbols = static_cast<uint32_t>(_symbols.size());
+        _out += _names;
+        head.names = static_cast<uint32_t>(_names.size());
+        head.checksum = fnv1a(_out);
+        std::string res(reinterpret_cast<char const *>(&head), sizeof head);
+        return res += _out;
+    }
+
+private:
+    std::optional<View> _into(std::string_view view) const {
+        if (view.empty()) return View{};
+        std::less_equal<char const *> const le;
+        if (!le(_text.data(), view.data()) || !le(view.data() + view.size(), _text.data() + _text.size())) return {};
+        return View{static_cast<uint32_t>(view.data() - _text.data()), static_cast<uint32_t>(view.size())};
+    }
+
+private:
+    std::string_view _text;
+    std::string _out, _names;
+    std::map<std::pair<char const *, size_t>, uint32_t> _offsets; // by where they are, the names saved
+    std::vector<uint32_t> _indices; // of the symbols saved, by id
+    std::vector<Symbol> _symbols;
+};
+
+// takes what a writer put in the same order, anything out of bounds makes it fail
+class Reader {
+public:
+    Reader(char const *at, Artifact const &head, std::string_view text, std::span<char const> names,
+           std::span<Symbol const> symbols = {})
+        : _at(at), _head(head), _text(text), _names(names), _symbols(symbols) {}
+
+    bool ok() const { return _ok; }
+
+    template <typename T> T get() {
+        T res;
+        std::memcpy(&res, _at, sizeof res);
+        _at += sizeof res;
+        return res;
+    }
+
+    std::string_view view(View view) {
+        if (view.size == 0) return {};
+        auto const end = uint64_t{view.offset} + view.size;
+        if (end <= _text.size()) return _text.substr(view.offset, view.size);
+        if (view.offset >= _text.size() && end <= _text.size() + _names.size()) {
+            return {_names.data() + (view.offset - _text.size()), view.size};
+        }
+        _ok = false;
+        return {};
+    }
+
+    Symbol symbol(uint32_t index) {
+        if (index < _symbols.size()) return _symbols[index];
+        _ok = false;
+        return {};
+    }
+
+    Ref ref(Ref ref) {
+        if (ref && (ref.type() < Type::Fact || ref.type() > Type::Void || ref.index() >= _head.pools[slot(ref.type())])) {
+            _ok = false;
+        }
+        return ref;
+    }
+
+    uint32_t index(uint32_t index, Type type) {
+        if (index >= _head.pools[slot(type)]) _ok = false;
+        return index;
+    }
+
+    uint32_t optional(uint32_t index, Type type) { return index == none ? none : this->index(index, type); }
+
+    uint32_t constant(uint32_t index) {
+        if (index >= _head.constants) _ok = false;
+        return index;
+    }
+
+    Range range(Range range) {
+        if (uint64_t{range.begin} + range.size > _head.lists) _ok = false;
+        return range;
+    }
+
+    Kind op(uint32_t op, std::map<Kind, Symbol> const &known) {
+        if (op >= Kind::Size || !known.contains(Kind(static_cast<uint16_t>(op)))) {
+            _ok = false;
+            return Kind::Invalid;
+        }
+        return static_cast<uint16_t>(op);
+    }
+
+    template <typename T> void spans(Pool<T> &pool) {
+        pool.spans.resize(pool.hot.size());
+        for (auto &span : pool.spans) {
+            span = view(get<View>());
+        }
+    }
+
+private:
+    char const *_at;
+    Artifact const &_head;
+    std::string_view _text;
+    std::span<char const> _names;
+    std::span<Symbol const> _symbols;
+    bool _ok = true;
+};
+
+} // namespace
+
 std::string Kind::show() const {
     return infos[_val].show;
 }
@@ -126,515 +392,836 @@ std::array<Kind::Info, Kind::Value::Size> const Kind::infos{
     {"GEpsilon",           "GEpsilon"},
 };
 
-Context::Context(std::string const &file) : file(file), global(set::std()) {}
-
-std::pair<Node::Pos, Node::Pos> Node::getRange(std::string const &str) const {
-    if (view._Unchecked_begin() < str._Unchecked_begin() || view._Unchecked_end() > str._Unchecked_end()) return {};
-
-    char const *begin = str._Unchecked_begin();
-    std::string_view const offset(begin, view._Unchecked_begin() - begin);
-    uint32_t const lfNum = std::count(offset.begin(), offset.end(), '\n');
-    uint32_t headColumn, tailColumn;
-    if (lfNum == 0) {
-        headColumn = offset.size();
-    } else {
-        headColumn = offset.size() - offset.find_last_of('\n') - 1;
-    }
-
-    uint32_t restLfNum = std::count(view.begin(), view.end(), '\n');
-    if (restLfNum == 0) {
-        tailColumn = view.size() + headColumn;
-    } else {
-        std::string_view const v(begin, view._Unchecked_end() - begin);
-        tailColumn = v.size() - v.find_last_of('\n') - 1;
-    }
-    return {
-        {            lfNum + 1, headColumn + 1},
-        {lfNum + restLfNum + 1,     tailColumn}
-    };
-}
+Context::Context(SourceManager const &sources) : global(set::std()), sources(sources) {}
 
 Node Node::combine(Node const &tail) const {
-    auto const *head = view._Unchecked_begin();
+    auto const *head = view.data();
     if (!head) return tail;
-    auto size = tail.view._Unchecked_end() - head;
+    auto size = tail.view.data() + tail.view.size() - head;
     return std::string_view{head, size_t(size)};
 }
 
-void Node::printCode(std::string const &file) const {
-    auto const [head, tail] = getRange(file);
-    if (head.line + head.column + tail.line + tail.column == 0) {
-        Quiet(), "code out of file '", view, "'\n\n";
-        std::cout << std::flush;
-        return;
-    }
-    auto const lineNum = "line " + std::to_string(head.line) + ": ";
-    Quiet<style::black>(), lineNum;
-    if (head.line != tail.line) {
-        Quiet(), "printing code... but has not support multiline yet🥺\n\n";
-        std::cout << std::flush;
-        return;
-    }
-    char const *begin = view._Unchecked_begin() + 1 - head.column;
-    std::istringstream iss(begin);
-    std::string line;
-    std::getline(iss, line);
-    Quiet(), line, '\n';
-    Quiet(), std::string(head.column - 1 + lineNum.size(), ' '), std::string(tail.column + 1 - head.column, '^'), '\n';
-    std::cout << std::flush;
-}
+Token::Token(Kind kind, std::string_view view) : Node(view), kind(kind) {}
 
-Module const *Set::digest(Context &ctx) {
-    if (_params) {
-        _params->digest(ctx);
-    }
-    if (auto const *modFind = ctx.scope.top()->find(view)) {
-        ref = modFind;
-    }
-    return ref;
-}
+Token::Token(Kind kind, Node const &node) : Node(node), kind(kind) {}
 
-Module const *Fact::digest(Context &ctx) {
-    if (auto *super = _lvalue->getSuperset()) {
-        super->digest(ctx);
-    }
-    return _rvalue ? _rvalue->digest(ctx) : nullptr;
-}
+Nonterm::Nonterm(Kind kind) : Token(kind, {}) {}
 
-Module const *Module::digest(Context &ctx) {
-    ctx.scope.push(this);
-    _stmts->digest(ctx);
-    for (auto const &module : _modules) {
-        module.second->digest(ctx);
-    }
-    ctx.scope.pop();
-    return this;
-}
+void Nonterm::pushArgs(std::span<Token *> tokens) {
+    view = tokens.front()->combine(*tokens.back()).view;
+    args = tokens;
+    size = static_cast<int>(tokens.size());
+};
 
-Module const *Statements::digest(Context &ctx) {
-    for (auto const &fact : get()) {
-        fact->digest(ctx);
-    }
-    return nullptr;
+void Token::dump(size_t indent) const {
+    std::cout << std::string(indent * 2, ' ') << "token\n";
 }
 
-Module const *Expression::digest(Context &ctx) {
-    auto const *module = _super ? _super->digest(ctx) : _extract->digest(ctx);
-    if (!module) {
-        module = ctx.scope.top();
-    }
-    auto const *ref = module->find(getExtractName());
-    if (ref) {
-        _extract->ref = ref;
-    } else {
-        auto f = module->getFacts().facts;
-        auto find = f.equal_range(getExtractName());
-        for (auto it = find.first; it != find.second; ++it) {
-            _extract->facts.push_back(it->second);
-        }
-    }
-    return ref;
+void Nonterm::dump(size_t indent) const {
+    std::cout << std::string(indent * 2, ' ') << "nonterm\n";
 }
 
-std::map<Kind, std::string_view> const Unary::table{
-    {Kind::Exclamation, "Not"},
-    {Kind::SingleMinus, "Neg"},
-};
-
-Module const *Unary::digest(Context &ctx) {
-    _params->digest(ctx);
-    auto id = table.at(_op);
-    if (auto const *module = ctx.scope.top()->find(id)) {
-        ref = module;
-    }
-    return ref;
-}
-
-std::map<Kind, std::string_view> const Binary::table{
-    {      Kind::SinglePlus,   "Add"},
-    {     Kind::SingleMinus,   "Sub"},
-    {  Kind::SingleAsterisk,   "Mul"},
-    {     Kind::SingleSlash,   "Div"},
-    {        Kind::LessThan,    "Lt"},
-    {       Kind::GreatThan,    "Gt"},
-    { Kind::LessThanOrEqual,  "Lteq"},
-    {Kind::GreatThanOrEqual,  "Gteq"},
-    {     Kind::DoubleEqual,    "Eq"},
-    {Kind::ExclamationEqual, "Noteq"},
-    {     Kind::Exclamation,   "Not"},
-    {       Kind::DoubleAnd,   "And"},
-    {        Kind::DoubleOr,    "Or"},
-};
+Ref Ast::set(std::string_view name) {
+    return _sets.add(Type::Set, {Symbol(name)}, name);
+}
 
-Module const *Binary::digest(Context &ctx) {
-    _params->digest(ctx);
-    if (auto const *find = ctx.scope.top()->find(table.at(_op))) {
-        ref = find;
-    }
-    return ref;
+Ref Ast::boolean(std::string_view view) {
+    return _bools.add(Type::Bool, {view.compare("true") == 0}, view);
 }
 
-set::Set Set::solve(Context &ctx) const {
-    auto params = _params ? _params->solve(ctx) : set::create<set::Sets>();
-    if (!params.ok()) {
-        return set::create();
-    }
-    if (ref) {
-        auto set = ref->solveWithParams(std::move(params), ctx);
-        return set;
-    }
-    if (auto local = ctx.params.top().extract(view); local.ok()) { // module a { b = c + 1 }
-        auto resolve = local.resolve(params);                      //                ^
-        return resolve;
-    }
-    if (auto global = ctx.global.extract(view); global.ok()) { // main = int
-        auto resolve = global.resolve(params);                 //        ^^^
-        return resolve;
-    }
-    auto solved = set::create();
-    Fact const *solvedFact;
-    for (auto const *f : facts) {
-        if (auto solving = f->solve(ctx); solving.ok()) {
-            if (solved.ok()) {
-                Quiet<style::red>(), "'", f->lvalue().view, "' ambiguous\n";
-                solvedFact->printCode(ctx.file);
-                f->printCode(ctx.file);
-                return set::create();
-            }
-            solved = std::move(solving);
-            solvedFact = f;
-        }
+Ref Ast::number(std::string_view view) {
+    auto const *const end = view.data() + view.size();
+    std::from_chars_result res{};
+    Constant value;
+    if (view.find('.') == std::string_view::npos) {
+        res = std::from_chars(view.data(), end, value.emplace<int64_t>());
+    } else {
+        res = std::from_chars(view.data(), end, value.emplace<double>());
     }
-    if (solved.ok()) {
-        return solved;
+    if (res.ec != std::errc{} || res.ptr != end) {
+        // what from_chars left over, the second dot on, makes it malformed
+        _badNumbers.push_back({view, res.ec != std::errc{} ? res.ec : std::errc::invalid_argument});
+        return _numbers.add(Type::Number, {none}, view);
     }
-
-    Quiet<style::yellow>(), "undefined extract '", view, "'\n";
-    printCode(ctx.file);
-    std::cout << std::flush;
-    return set::create();
+    return _numbers.add(Type::Number, {_constant(value)}, view);
 }
 
-set::Set Expression::solve(Context &ctx) const {
-    if (_super) {
-        auto super = _super->solve(ctx);
-        if (!super.ok()) {
-            return set::create();
-        }
-        if (auto ex = super.extract(_extract->view); ex.ok()) {
-            return ex;
-        }
-    }
-    if (auto solve = _extract->solve(ctx); solve.ok()) {
-        return solve;
-    }
-    Quiet<style::yellow>(), "undeclared set '", _extract->view, "'\n";
-    _extract->printCode(ctx.file);
-    return set::create();
+Ref Ast::empty(std::string_view view) {
+    return _voids.add(Type::Void, {}, view);
 }
 
-set::Set Unary::solve(Context &ctx) const {
-    auto const params = _params->solve(ctx);
-    if (!params.ok()) {
-        return set::create();
-    }
-    if (auto ex = ctx.global.extract(table.at(_op)); ex.ok()) {
-        return ex.resolve(std::move(params)).extract("extract");
-    }
-    return set::create();
+Ref Ast::fact(Ref lvalue, Ref rvalue) {
+    auto const span = rvalue ? join(this->span(lvalue), this->span(rvalue)) : this->span(lvalue);
+    return _facts.add(Type::Fact, {lvalue.index(), rvalue}, span);
 }
 
-set::Set Binary::solve(Context &ctx) const {
-    auto const params = _params->solve(ctx);
-    if (!params.ok()) {
-        return set::create();
-    }
-    if (ref) {
-        if (auto local = ref->solveWithParams(params.clone(), ctx); local.ok()) {
-            return local.extract("extract");
+Ref Ast::module(Ref list, std::string_view name, std::string_view written) {
+    auto const span = written.empty() ? this->span(list) : written;
+    auto const symbol = Symbol(name);
+    std::vector<uint32_t> modules;
+    auto const facts = _take(list, &modules);
+    for (auto m : modules) {
+        if (_modules.hot[m].name == symbol) {
+            Quiet<style::red>(), "module '", name, "' has the same name as parent\n";
         }
     }
-    if (auto ex = ctx.global.extract(table.at(_op)); ex.ok()) {
-        return ex.resolve(params).extract("extract");
-    }
-    return set::create();
+    // looked up by name, the first of a name wins
+    std::ranges::stable_sort(modules, {}, [this](uint32_t m) { return _modules.hot[m].name; });
+    auto const dups = std::ranges::unique(modules, {}, [this](uint32_t m) { return _modules.hot[m].name; });
+    modules.erase(dups.begin(), dups.end());
+    Range const subs{static_cast<uint32_t>(_lists.size()), static_cast<uint32_t>(modules.size())};
+    _lists.insert(_lists.end(), modules.begin(), modules.end());
+    return _modules.add(Type::Module, {symbol, facts, subs}, span);
 }
 
-set::Set Fact::solve(Context &ctx) const {
-    if (!_rvalue) return set::create();
-    auto rsolve = _rvalue->solve(ctx);
-    if (!rsolve.ok()) {
-        return set::create();
-    }
-    auto const &lannot = _lvalue->cast<Set>().getSuperset();
-    // default lvalue superset is universe
-    auto lsuperset = lannot ? lannot->solve(ctx) : set::create<set::Universe>();
-    auto sameSuper = lsuperset.contains(rsolve);
-    if (!sameSuper.ok()) {
-        return set::create();
-    }
-    if (!sameSuper.cast<set::Bool>().value()) {
-        return set::create();
-    }
-    return rsolve;
+Ref Ast::expression(Ref extract, Ref super) {
+    auto const span = super ? join(this->span(extract), this->span(super)) : this->span(extract);
+    return _expressions.add(Type::Expression, {extract.index(), super ? super.index() : none}, span);
 }
 
-set::Set Statements::solve(Context &ctx) const {
-    auto sets = std::make_unique<set::Sets>();
-    for (auto const &s : get()) {
-        auto &fact = s->cast<Fact>();
-        auto name = fact.lvalue().view;
-        auto solve = s->solve(ctx);
-        if (!solve.ok()) {
-            return set::create();
-        }
-        bool ambiguous = !sets->add(name, solve.move());
-        if (ambiguous) {
-            Quiet<style::red>(), "'", name, "' ambiguous\n";
-            fact.printCode(ctx.file);
-            return set::create();
-        }
-    }
-    return {std::move(sets)};
+Ref Ast::unary(Kind op, std::string_view view) {
+    return _unaries.add(Type::Unary, {op}, view);
 }
 
-set::Set Module::solve(Context &ctx) const {
-    auto res = set::create<set::Sets>();
-    auto &set = res.cast<set::Sets>();
-    for (auto const &stmt : _stmts->get()) {
-        auto const &fact = stmt->cast<Fact>();
-        auto name = fact.lvalue().view;
-        if (auto ex = ctx.params.top().extract(name); ex.ok()) {
-            set.add(name, ex.move());
-        } else {
-            auto solve = fact.solve(ctx);
-            auto debug = solve.clone();
-            bool ambiguous = !set.add(name, solve.move());
-            if (ambiguous) {
-                Quiet<style::red>(), "'", name, "' ambiguous\n";
-                fact.printCode(ctx.file);
-                return set::create();
-            }
-        }
-    }
-    return res;
+Ref Ast::binary(Kind op, std::string_view view) {
+    _waiting.push_back(none);
+    return _binaries.add(Type::Binary, {op}, view);
 }
 
-Token::Token(Kind kind, std::string_view view) : Node(view), kind(kind) {}
-
-Token::Token(Kind kind, Node const &node) : Node(node), kind(kind) {}
-
-set::Set Token::solveWithParams(set::Set params, Context &ctx) const {
-    ctx.params.push(std::move(params));
-    auto slv = solve(ctx);
-    ctx.params.pop();
-    return slv;
+void Ast::setSuperset(Ref set, Ref annotation) {
+    _sets.hot[set.index()].annotation = annotation;
 }
 
-Nonterm::Nonterm(Kind kind) : Token(kind, {}) {}
-
-void Nonterm::pushArgs(std::vector<std::unique_ptr<Token>> tokens) {
-    view = tokens.front()->combine(*tokens.back()).view;
-    args = std::move(tokens);
-};
-
-Set::Set(std::string_view view, std::unique_ptr<Token> &&annotation, std::unique_ptr<Token> &&params)
-    : Token(Kind::Set, view), _annotation(std::move(annotation)), _params(&params.release()->cast<Statements>()) {}
+void Ast::setParams(Ref set, Ref list) {
+    std::vector<uint32_t> modules;
+    _sets.hot[set.index()].params = _take(list, &modules);
+    for (auto const m : modules) {
+        _misplacedModules.push_back(_modules.spans[m]);
+    }
+}
 
-void Set::setSuperset(std::unique_ptr<Token> &&set) {
-    _annotation = std::move(set);
+void Ast::setOperand(Ref unary, Ref operand) {
+    auto const i = unary.index();
+    _unaries.spans[i] = join(_unaries.spans[i], span(operand));
+    _unaries.hot[i].operand = operand;
 }
 
-Token *Set::getSuperset() {
-    return _annotation.get();
+void Ast::setLhs(Ref binary, Ref lhs) {
+    // reassociating a chain sets the lhs of its innermost binary over and over, the shortcut keeps that linear
+    auto const self = binary.index();
+    auto target = self;
+    while (_waiting[target] != none) {
+        target = _waiting[target];
+    }
+    auto const next = lhs.type() == Type::Binary ? lhs.index() : none;
+    if (next != none) {
+        _waiting[target] = next;
+    }
+    if (target != self) {
+        _waiting[self] = next != none ? next : target;
+    }
+    _binaries.spans[target] = join(span(lhs), _binaries.spans[target]);
+    _binaries.hot[target].lhs = lhs;
 }
 
-void Set::setParams(std::unique_ptr<Token> &&params) {
-    _params.reset(&params.release()->cast<Statements>());
+void Ast::setRhs(Ref binary, Ref rhs) {
+    auto const i = binary.index();
+    _binaries.spans[i] = join(_binaries.spans[i], span(rhs));
+    _binaries.hot[i].rhs = rhs;
 }
 
-Expression::Expression(std::unique_ptr<Token> &&extract, std::unique_ptr<Token> &&super)
-    : Token(Kind::Expr, extract->view), _extract(&extract.release()->cast<Set>()) {
-    if (super) {
-        _super.reset(&super.release()->cast<Expression>());
-        view = combine(*_super).view;
+Ref Ast::list(Ref stmt) {
+    uint32_t index{};
+    if (_taken.empty()) {
+        index = static_cast<uint32_t>(_open.size());
+        _open.emplace_back();
     } else {
-        _super = nullptr;
+        index = _taken.back();
+        _taken.pop_back();
     }
+    Ref const res{Type::List, index};
+    pushFront(res, stmt);
+    return res;
 }
 
-void Expression::setExtract(std::unique_ptr<Token> &&extract) {
-    _extract.reset(&extract.release()->cast<Set>());
+void Ast::pushFront(Ref list, Ref stmt) {
+    if (stmt) _open[list.index()].push_back(stmt);
 }
 
-void Expression::setSuperset(std::unique_ptr<Token> &&super) {
-    _super.reset(&super.release()->cast<Expression>());
-    view = combine(*super).view;
+Range Ast::_take(Ref list, std::vector<uint32_t> *modules) {
+    Range res{static_cast<uint32_t>(_lists.size()), 0};
+    if (!list) return res;
+    auto &stmts = _open[list.index()];
+    for (auto it = stmts.rbegin(); it != stmts.rend(); ++it) {
+        if (it->type() == Type::Fact) {
+            _lists.push_back(it->index());
+            ++res.size;
+        } else if (modules) {
+            modules->push_back(it->index());
+        }
+    }
+    stmts.clear();
+    _taken.push_back(list.index());
+    return res;
 }
 
-std::string_view Expression::getExtractName() const {
-    return _extract->view;
-}
+Ref Ast::append(Ref list, Ast &&other, Ref others) {
+    if (!list && nodes() == 0) {
+        *this = std::move(other);
+        return others;
+    }
+    if (!list) list = this->list({});
+    if (!others) return list;
+    // other is left out if it does not fit, the overflow is reported instead
+    if (!fits(_facts, other._facts) || !fits(_modules, other._modules) || !fits(_sets, other._sets) ||
+        !fits(_expressions, other._expressions) || !fits(_unaries, other._unaries) ||
+        !fits(_binaries, other._binaries) || !fits(_numbers, other._numbers) || !fits(_bools, other._bools) ||
+        !fits(_voids, other._voids)) {
+        other = {};
+        return list;
+    }
 
-Module const *Expression::getModule() const {
-    return _extract->ref;
-}
+    // every index of other moves up by the size of the pool it points into
+    std::array<uint32_t, static_cast<size_t>(Type::Void) + 1> shift{};
+    auto const at = [&shift](Type type) -> uint32_t & { return shift[static_cast<size_t>(type)]; };
+    at(Type::Fact) = static_cast<uint32_t>(_facts.hot.size());
+    at(Type::Module) = static_cast<uint32_t>(_modules.hot.size());
+    at(Type::Set) = static_cast<uint32_t>(_sets.hot.size());
+    at(Type::Expression) = static_cast<uint32_t>(_expressions.hot.size());
+    at(Type::Unary) = static_cast<uint32_t>(_unaries.hot.size());
+    at(Type::Binary) = static_cast<uint32_t>(_binaries.hot.size());
+    at(Type::Number) = static_cast<uint32_t>(_numbers.hot.size());
+    at(Type::Bool) = static_cast<uint32_t>(_bools.hot.size());
+    at(Type::Void) = static_cast<uint32_t>(_voids.hot.size());
+    auto const move = [&](Ref ref) { return ref ? Ref(ref.type(), ref.index() + at(ref.type())) : ref; };
+    auto const index = [&](uint32_t i, Type type) { return i == none ? none : i + at(type); };
+    auto const lists = static_cast<uint32_t>(_lists.size());
+    auto const range = [&](Range r, Type type) {
+        for (auto k = r.begin; k < r.begin + r.size; ++k) {
+            other._lists[k] += at(type);
+        }
+        return Range{r.begin + lists, r.size};
+    };
 
-void Unary::setParam(std::unique_ptr<Token> &&param) {
-    view = combine(*param).view;
-    auto factView = param->view;
-    auto fact = std::make_unique<Fact>(std::make_unique<Set>("v"), std::move(param));
-    fact->view = factView;
-    _params = std::make_unique<Statements>(std::move(fact));
+    for (auto &fact : other._facts.hot) {
+        fact.lvalue += at(Type::Set);
+        fact.rvalue = move(fact.rvalue);
+    }
+    for (auto &module : other._modules.hot) {
+        module.facts = range(module.facts, Type::Fact);
+        module.modules = range(module.modules, Type::Module);
+    }
+    for (auto &set : other._sets.hot) {
+        set.annotation = move(set.annotation);
+        set.ref = index(set.ref, Type::Module);
+        set.params = range(set.params, Type::Fact);
+        set.facts = range(set.facts, Type::Fact);
+    }
+    for (auto &expression : other._expressions.hot) {
+        expression.extract += at(Type::Set);
+        expression.super = index(expression.super, Type::Expression);
+    }
+    for (auto &unary : other._unaries.hot) {
+        unary.operand = move(unary.operand);
+    }
+    for (auto &binary : other._binaries.hot) {
+        binary.lhs = move(binary.lhs);
+        binary.rhs = move(binary.rhs);
+        binary.ref = index(binary.ref, Type::Module);
+    }
+    for (auto &waiting : other._waiting) {
+        waiting = index(waiting, Type::Binary);
+    }
+    // the constants are pooled again, those both have are kept once
+    for (auto &number : other._numbers.hot) {
+        if (number.constant != none) number.constant = _constant(other._constants[number.constant]);
+    }
+    concat(_facts, other._facts);
+    concat(_modules, other._modules);
+    concat(_sets, other._sets);
+    concat(_expressions, other._expressions);
+    concat(_unaries, other._unaries);
+    concat(_binaries, other._binaries);
+    concat(_numbers, other._numbers);
+    concat(_bools, other._bools);
+    concat(_voids, other._voids);
+    _lists.insert(_lists.end(), other._lists.begin(), other._lists.end());
+    _waiting.insert(_waiting.end(), other._waiting.begin(), other._waiting.end());
+    _badNumbers.insert(_badNumbers.end(), other._badNumbers.begin(), other._badNumbers.end());
+    _misplacedModules.insert(_misplacedModules.end(), other._misplacedModules.begin(), other._misplacedModules.end());
+
+    // both last first, the statements of other go in front
+    auto const &from = other._open[others.index()];
+    auto &to = _open[list.index()];
+    to.insert(to.begin(), from.size(), {});
+    std::ranges::transform(from, to.begin(), move);
+    other = {};
+    return list;
 }
 
-void Binary::setLhs(std::unique_ptr<Token> &&param) {
-    if (_binaryLhs) {
-        _binaryLhs->setLhs(std::move(param));
-        return;
+std::string_view Ast::span(Ref node) const {
+    auto const i = node.index();
+    switch (node.type()) {
+    case Type::List: {
+        auto const &stmts = _open[i];
+        return stmts.empty() ? std::string_view{} : join(span(stmts.back()), span(stmts.front()));
     }
-    if (param->kind == Kind::Binary) {
-        _binaryLhs = &param->cast<Binary>();
+    case Type::Fact: return _facts.spans[i];
+    case Type::Module: return _modules.spans[i];
+    case Type::Set: return _sets.spans[i];
+    case Type::Expression: return _expressions.spans[i];
+    case Type::Unary: return _unaries.spans[i];
+    case Type::Binary: return _binaries.spans[i];
+    case Type::Number: return _numbers.spans[i];
+    case Type::Bool: return _bools.spans[i];
+    case Type::Void: return _voids.spans[i];
+    default: return {};
     }
-    view = param->combine(*this).view;
-    auto factView = param->view;
-    auto fact = std::make_unique<Fact>(std::make_unique<Set>("x"), std::move(param));
-    fact->view = factView;
-    _params->pushFront(std::move(fact));
 }
 
-void Binary::setRhs(std::unique_ptr<Token> &&param) {
-    view = combine(*param).view;
-    auto factView = param->view;
-    auto fact = std::make_unique<Fact>(std::make_unique<Set>("y"), std::move(param));
-    fact->view = factView;
-    _params->pushBack(std::move(fact));
+std::optional<std::string_view> Ast::overflow() const {
+    for (auto const &overflow : {_facts.overflow, _modules.overflow, _sets.overflow, _expressions.overflow,
+                                 _unaries.overflow, _binaries.overflow, _numbers.overflow, _bools.overflow,
+                                 _voids.overflow}) {
+        if (overflow) return overflow;
+    }
+    return {};
 }
 
-Fact::Fact(std::unique_ptr<Token> &&lvalue, std::unique_ptr<Token> &&rvalue)
-    : Token(Kind::Fact, rvalue ? lvalue->combine(*rvalue) : lvalue->view),
-      _lvalue(&lvalue.release()->cast<Set>()),
-      _rvalue(std::move(rvalue)) {}
+size_t Ast::nodes() const {
+    return _facts.hot.size() + _modules.hot.size() + _sets.hot.size() + _expressions.hot.size() + _unaries.hot.size() +
+           _binaries.hot.size() + _numbers.hot.size() + _bools.hot.size() + _voids.hot.size();
+}
 
-void Statements::pushFront(std::unique_ptr<Token> &&stmt) {
-    if (!stmt) return;
-    _statements.push_front(std::move(stmt));
-    view = _statements.front()->combine(*_statements.back()).view;
+size_t Ast::bytes() const {
+    auto res = _facts.bytes() + _modules.bytes() + _sets.bytes() + _expressions.bytes() + _unaries.bytes() +
+               _binaries.bytes() + _numbers.bytes() + _bools.bytes() + _voids.bytes();
+    res += (_lists.capacity() + _taken.capacity() + _waiting.capacity()) * sizeof(uint32_t) + _names.capacity();
+    res += _constants.capacity() * sizeof(Constant);
+    for (auto const &list : _open) {
+        res += list.capacity() * sizeof(Ref);
+    }
+    return res;
 }
 
-void Statements::pushBack(std::unique_ptr<Token> &&stmt) {
-    if (!stmt) return;
-    _statements.push_back(std::move(stmt));
-    view = _statements.front()->combine(*_statements.back()).view;
+std::string Ast::save(uint64_t key, std::string_view text, std::span<Ref const> roots) const {
+    // the names come after the text, both are addressed by 32 bits
+    if (text.size() > std::numeric_limits<uint32_t>::max() / 2) return {};
+    Artifact head{artifactMagic,
+                  key,
+                  {},
+                  artifactVersion,
+                  static_cast<uint32_t>(roots.size()),
+                  static_cast<uint32_t>(_lists.size()),
+                  static_cast<uint32_t>(_constants.size()),
+                  {},
+                  {},
+                  {},
+                  {}};
+    auto const sizes = std::to_array({_facts.hot.size(), _modules.hot.size(), _sets.hot.size(), _expressions.hot.size(),
+                                      _unaries.hot.size(), _binaries.hot.size(), _numbers.hot.size(), _bools.hot.size(),
+                                      _voids.hot.size()});
+    std::ranges::transform(sizes, head.pools.begin(), [](size_t size) { return static_cast<uint32_t>(size); });
+
+    Writer out(text);
+    for (auto root : roots) {
+        out.put(root);
+    }
+    for (auto const &fact : _facts.hot) {
+        out.put(fact);
+    }
+    for (auto const &module : _modules.hot) {
+        out.put(ModuleRecord{out.symbol(module.name), module.facts, module.modules});
+    }
+    for (auto const &set : _sets.hot) {
+        out.put(SetRecord{out.symbol(set.name), set.annotation, set.ref, set.params, set.facts});
+    }
+    for (auto const &expression : _expressions.hot) {
+        out.put(expression);
+    }
+    for (auto const &unary : _unaries.hot) {
+        out.put(UnaryRecord{unary.op.value(), unary.operand});
+    }
+    for (auto const &binary : _binaries.hot) {
+        out.put(BinaryRecord{binary.op.value(), binary.lhs, binary.rhs, binary.ref});
+    }
+    for (auto const &number : _numbers.hot) {
+        out.put(number);
+    }
+    for (auto const &boolean : _bools.hot) {
+        out.put(static_cast<uint8_t>(boolean.value));
+    }
+    out.names(_sets);
+    out.spans(_facts);
+    out.spans(_modules);
+    out.spans(_expressions);
+    out.spans(_unaries);
+    out.spans(_binaries);
+    out.spans(_numbers);
+    out.spans(_bools);
+    out.spans(_voids);
+    for (auto i : _lists) {
+        out.put(i);
+    }
+    for (auto const &constant : _constants) {
+        out.put(static_cast<uint8_t>(constant.index()));
+        out.put(std::visit([](auto value) { return std::bit_cast<uint64_t>(value); }, constant));
+    }
+    return out.finish(head);
 }
 
-Module::Module(std::unique_ptr<Token> &&statements, Node const &node, std::string name)
-    : Token(Kind::Module, node),
-      _stmts(std::make_unique<Statements>()),
-      _name(std::move(name)) // \n
-{
-    _stmts.reset(&statements.release()->cast<Statements>());
-    view = _stmts->view;
-    auto &stmts = _stmts->_statements;
-    for (auto it = stmts.begin(); it != stmts.end();) {
-        auto &stmt = *it;
-        if (stmt->kind == Kind::Module) {
-            auto module = std::unique_ptr<Module>(&stmt.release()->cast<Module>());
-            auto const &name = module->getName();
-            if (name == _name) {
-                Quiet<style::red>(), "module '", name, "' has the same name as parent\n";
-            }
-            _modules.insert({name, std::move(module)});
-            it = stmts.erase(it);
+bool Ast::load(std::string_view artifact, uint64_t key, std::string_view text, std::span<Ref> roots) {
+    Artifact head;
+    if (artifact.size() < sizeof head) return false;
+    std::memcpy(&head, artifact.data(), sizeof head);
+    if (head.magic != artifactMagic || head.version != artifactVersion || head.key != key ||
+        head.roots != roots.size() || head.spare != 0) {
+        return false;
+    }
+    auto size = sizeof head + head.roots * sizeof(Ref) + uint64_t{head.lists} * sizeof(uint32_t) +
+                uint64_t{head.constants} * constantSize + uint64_t{head.symbols} * sizeof(View) + head.names;
+    for (size_t p{}; p < head.pools.size(); ++p) {
+        if (head.pools[p] > maxIndex) return false; // more than a ref can index
+        size += head.pools[p] * (recordSizes[p] + sizeof(View));
+    }
+    auto const payload = artifact.substr(sizeof head);
+    if (artifact.size() != size || fnv1a(payload) != head.checksum) return false;
+
+    Ast ast;
+    ast._names.assign(payload.end() - head.names, payload.end());
+    // each name saved is interned once, the nodes then take the ids of this process
+    std::vector<Symbol> symbols(head.symbols);
+    Reader table(payload.data() + payload.size() - head.names - head.symbols * sizeof(View), head, text, ast._names);
+    for (auto &symbol : symbols) {
+        symbol = Symbol(table.view(table.get<View>()));
+    }
+    Reader in(payload.data(), head, text, ast._names, symbols);
+    std::vector<Ref> saved(roots.size());
+    for (auto &root : saved) {
+        root = in.ref(in.get<Ref>());
+    }
+    ast._facts.hot.resize(head.pools[slot(Type::Fact)]);
+    for (auto &fact : ast._facts.hot) {
+        auto const saved = in.get<Fact>();
+        fact = {in.index(saved.lvalue, Type::Set), in.ref(saved.rvalue)};
+    }
+    ast._modules.hot.resize(head.pools[slot(Type::Module)]);
+    for (auto &module : ast._modules.hot) {
+        auto const saved = in.get<ModuleRecord>();
+        module = {in.symbol(saved.name), in.range(saved.facts), in.range(saved.modules)};
+    }
+    ast._sets.hot.resize(head.pools[slot(Type::Set)]);
+    for (auto &set : ast._sets.hot) {
+        auto const saved = in.get<SetRecord>();
+        set = {in.symbol(saved.name), in.ref(saved.annotation), in.optional(saved.ref, Type::Module),
+               in.range(saved.params), in.range(saved.facts)};
+    }
+    ast._expressions.hot.resize(head.pools[slot(Type::Expression)]);
+    for (auto &expression : ast._expressions.hot) {
+        auto const saved = in.get<Expression>();
+        expression = {in.index(saved.extract, Type::Set), in.optional(saved.super, Type::Expression)};
+    }
+    ast._unaries.hot.resize(head.pools[slot(Type::Unary)], {Kind::Invalid});
+    for (auto &unary : ast._unaries.hot) {
+        auto const saved = in.get<UnaryRecord>();
+        unary = {in.op(saved.op, unaries), in.ref(saved.operand)};
+    }
+    ast._binaries.hot.resize(head.pools[slot(Type::Binary)], {Kind::Invalid});
+    for (auto &binary : ast._binaries.hot) {
+        auto const saved = in.get<BinaryRecord>();
+        binary = {in.op(saved.op, binaries), in.ref(saved.lhs), in.ref(saved.rhs), in.optional(saved.ref, Type::Module)};
+    }
+    ast._numbers.hot.resize(head.pools[slot(Type::Number)]);
+    for (auto &number : ast._numbers.hot) {
+        number = {in.constant(in.get<Number>().constant)};
+    }
+    ast._bools.hot.resize(head.pools[slot(Type::Bool)]);
+    for (auto &boolean : ast._bools.hot) {
+        auto const saved = in.get<uint8_t>();
+        boolean = {saved == 1};
+        if (saved > 1) return false;
+    }
+    ast._voids.hot.resize(head.pools[slot(Type::Void)]);
+    in.spans(ast._sets);
+    in.spans(ast._facts);
+    in.spans(ast._modules);
+    in.spans(ast._expressions);
+    in.spans(ast._unaries);
+    in.spans(ast._binaries);
+    in.spans(ast._numbers);
+    in.spans(ast._bools);
+    in.spans(ast._voids);
+    ast._lists.resize(head.lists);
+    for (auto &i : ast._lists) {
+        i = in.get<uint32_t>();
+    }
+    ast._constants.resize(head.constants);
+    for (auto &constant : ast._constants) {
+        auto const alternative = in.get<uint8_t>();
+        auto const bits = in.get<uint64_t>();
+        if (alternative == 0) {
+            constant = std::bit_cast<int64_t>(bits);
+        } else if (alternative == 1) {
+            constant = std::bit_cast<double>(bits);
         } else {
-            ++it;
+            return false;
         }
     }
-}
+    if (!in.ok() || !table.ok()) return false;
 
-node::Module::Module(Modules &&modules)
-    : Token(Kind::Module, {}), _stmts(std::make_unique<Statements>()), _name("std"), _modules(std::move(modules)) {}
-
-void Module::setName(std::string const &name) {
-    _name = name;
-}
-
-void Module::setName(std::string_view const &name) {
-    _name = name;
-    view = Node(name).combine(*this).view;
+    // the lists hold facts but for the submodules
+    auto const within = [&ast](Range range, size_t size) {
+        return std::ranges::all_of(ast._list(range), [size](uint32_t i) { return i < size; });
+    };
+    auto const facts = ast._facts.hot.size(), modules = ast._modules.hot.size();
+    bool const ok =
+        std::ranges::all_of(ast._modules.hot,
+                            [&](Module const &m) { return within(m.facts, facts) && within(m.modules, modules); }) &&
+        std::ranges::all_of(ast._sets.hot, [&](Set const &s) { return within(s.params, facts) && within(s.facts, facts); });
+    if (!ok) return false;
+    // the submodules are looked up by the ids of their names
+    for (auto const &module : ast._modules.hot) {
+        auto const subs = std::span(ast._lists).subspan(module.modules.begin, module.modules.size);
+        std::ranges::sort(subs, {}, [&ast](uint32_t m) { return ast._modules.hot[m].name; });
+    }
+    ast._waiting.assign(ast._binaries.hot.size(), none);
+    *this = std::move(ast);
+    std::ranges::copy(saved, roots.begin());
+    return true;
 }
 
-std::string const &Module::getName() const {
-    return _name;
+uint32_t Ast::_constant(Constant value) {
+    auto const [it, fresh] = _pooled.try_emplace(value, static_cast<uint32_t>(_constants.size()));
+    if (fresh) _constants.push_back(value);
+    return it->second;
 }
 
-Module::Facts Module::getFacts() const {
-    auto m = Module::Facts(getName());
-    for (auto const &s : _stmts->get()) {
-        auto &fact = s->cast<Fact>();
-        auto name = fact.lvalue().view;
-        m.facts.emplace(name, &fact);
+uint32_t Ast::_find(uint32_t module, Symbol name) const {
+    auto const &self = _modules.hot[module];
+    if (name == self.name) {
+        return module;
     }
-    return m;
+    auto const subs = _list(self.modules);
+    auto const it = std::ranges::lower_bound(subs, name, {}, [this](uint32_t m) { return _modules.hot[m].name; });
+    return it != subs.end() && _modules.hot[*it].name == name ? *it : none;
 }
 
-Module const *Module::find(std::string_view name) const {
-    if (name == _name) {
-        return this;
+uint32_t Ast::digest(Ref node, Context &ctx) {
+    // the facts a set may extract are put behind the lists while they are walked, so these go by index
+    auto const each = [this](Range range, auto &&f) {
+        for (auto k = range.begin; k < range.begin + range.size; ++k) {
+            f(_lists[k]);
+        }
+    };
+    auto const facts = [&](uint32_t fact) { digest({Type::Fact, fact}, ctx); };
+    auto const i = node.index();
+    switch (node.type()) {
+    case Type::Set: {
+        each(_sets.hot[i].params, facts);
+        if (auto const found = _find(ctx.scope.top(), _sets.hot[i].name); found != none) {
+            _sets.hot[i].ref = found;
+        }
+        return _sets.hot[i].ref;
     }
-    auto f = _modules.find(name);
-    if (f != _modules.end()) {
-        return f->second.get();
+    case Type::Fact: {
+        auto const fact = _facts.hot[i];
+        if (auto const annotation = _sets.hot[fact.lvalue].annotation) {
+            digest(annotation, ctx);
+        }
+        return fact.rvalue ? digest(fact.rvalue, ctx) : none;
+    }
+    case Type::Module: {
+        ctx.scope.push(i);
+        each(_modules.hot[i].facts, facts);
+        each(_modules.hot[i].modules, [&](uint32_t m) { digest({Type::Module, m}, ctx); });
+        ctx.scope.pop();
+        return i;
+    }
+    case Type::Expression: {
+        auto const expression = _expressions.hot[i];
+        auto module = expression.super != none ? digest({Type::Expression, expression.super}, ctx)
+                                               : digest({Type::Set, expression.extract}, ctx);
+        if (module == none) {
+            module = ctx.scope.top();
+        }
+        auto const name = _sets.hot[expression.extract].name;
+        auto const ref = _find(module, name);
+        if (ref != none) {
+            _sets.hot[expression.extract].ref = ref;
+            return ref;
+        }
+        auto const before = _sets.hot[expression.extract].facts;
+        Range found{static_cast<uint32_t>(_lists.size()), before.size};
+        each(before, [&](uint32_t fact) { _lists.push_back(fact); });
+        each(_modules.hot[module].facts, [&](uint32_t fact) {
+            if (_sets.hot[_facts.hot[fact].lvalue].name != name) return;
+            _lists.push_back(fact);
+            ++found.size;
+        });
+        _sets.hot[expression.extract].facts = found;
+        return ref;
+    }
+    case Type::Unary: {
+        // down a chain of unaries as - - 1 parses without recursing on it
+        auto operand = _unaries.hot[i].operand;
+        while (operand.type() == Type::Unary) {
+            operand = _unaries.hot[operand.index()].operand;
+        }
+        if (operand) digest(operand, ctx);
+        return none;
+    }
+    case Type::Binary: {
+        // a chain of binaries down their lhs, as 1 + 1 + 1 parses, bottom up without recursing on it
+        std::vector<uint32_t> chain{i};
+        while (_binaries.hot[chain.back()].lhs.type() == Type::Binary) {
+            chain.push_back(_binaries.hot[chain.back()].lhs.index());
+        }
+        if (auto const lhs = _binaries.hot[chain.back()].lhs) digest(lhs, ctx);
+        for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+            if (auto const rhs = _binaries.hot[*it].rhs) digest(rhs, ctx);
+            if (auto const found = _find(ctx.scope.top(), binaries.at(_binaries.hot[*it].op)); found != none) {
+                _binaries.hot[*it].ref = found;
+            }
+        }
+        return _binaries.hot[i].ref;
+    }
+    default: return none;
     }
-    return nullptr;
-}
-
-void Token::dump(size_t indent) const {
-    std::cout << std::string(indent * 2, ' ') << "token\n";
-}
-
-void Nonterm::dump(size_t indent) const {
-    std::cout << std::string(indent * 2, ' ') << "nonterm\n";
-}
-
-void Set::dump(size_t indent) const {
-    std::cout << std::string(indent * 2, ' ') << view << "\n";
-    if (_params) _params->dump(indent + 1);
 }
 
-void Expression::dump(size_t indent) const {
-    std::cout << std::string(indent * 2, ' ') << "extract " << _extract->view << ": "
-              << (_super ? _super->getExtractName() : "?") << "\n";
-    if (_extract) _extract->dump(indent + 1);
-    if (_super) _super->dump(indent + 1);
-}
+set::Set Ast::solve(Ref node, Context &ctx) const {
+    auto const i = node.index();
+    switch (node.type()) {
+    case Type::Set: {
+        auto const &set = _sets.hot[i];
+        auto params = set.params.size > 0 ? _solve(_list(set.params), ctx) : set::create<set::Sets>();
+        if (!params.ok()) {
+            return set::create();
+        }
+        if (set.ref != none) {
+            return solveWithParams(set.ref, std::move(params), ctx);
+        }
+        if (auto local = ctx.params.top().extract(set.name); local.ok()) { // module a { b = c + 1 }
+            return local.resolve(params);                                  //                ^
+        }
+        if (auto global = ctx.global.extract(set.name); global.ok()) { // main = int
+            return global.resolve(params);                             //        ^^^
+        }
+        auto solved = set::create();
+        uint32_t solvedFact{};
+        for (auto const f : _list(set.facts)) {
+            if (auto solving = solve({Type::Fact, f}, ctx); solving.ok()) {
+                if (solved.ok()) {
+                    Quiet<style::red>(), "'", _sets.hot[_facts.hot[f].lvalue].name.view(), "' ambiguous\n";
+                    ctx.sources.print(_facts.spans[solvedFact]);
+                    ctx.sources.print(_facts.spans[f]);
+                    return set::create();
+                }
+                solved = std::move(solving);
+                solvedFact = f;
+            }
+        }
+        if (solved.ok()) {
+            return solved;
+        }
 
-void Unary::dump(size_t indent) const {
-    std::cout << std::string(indent * 2, ' ') << _op.show() << "\n";
-    _params->dump(indent + 1);
+        Quiet<style::yellow>(), "undefined extract '", set.name.view(), "'\n";
+        ctx.sources.print(_sets.spans[i]);
+        std::cout << std::flush;
+        return set::create();
+    }
+    case Type::Fact: {
+        auto const &fact = _facts.hot[i];
+        if (!fact.rvalue) return set::create();
+        auto rsolve = solve(fact.rvalue, ctx);
+        if (!rsolve.ok()) {
+            return set::create();
+        }
+        auto const annotation = _sets.hot[fact.lvalue].annotation;
+        // default lvalue superset is universe
+        auto lsuperset = annotation ? solve(annotation, ctx) : set::create<set::Universe>();
+        auto sameSuper = lsuperset.contains(rsolve);
+        if (!sameSuper.ok()) {
+            return set::create();
+        }
+        if (!sameSuper.cast<set::Bool>().value()) {
+            return set::create();
+        }
+        return rsolve;
+    }
+    case Type::Module: {
+        auto res = set::create<set::Sets>();
+        auto &sets = res.cast<set::Sets>();
+        for (auto const f : _list(_modules.hot[i].facts)) {
+            auto const name = _sets.hot[_facts.hot[f].lvalue].name;
+            if (auto ex = ctx.params.top().extract(name); ex.ok()) {
+                sets.add(name, ex.move());
+            } else {
+                auto solve = this->solve({Type::Fact, f}, ctx);
+                bool ambiguous = !sets.add(name, solve.move());
+                if (ambiguous) {
+                    Quiet<style::red>(), "'", name.view(), "' ambiguous\n";
+                    ctx.sources.print(_facts.spans[f]);
+                    return set::create();
+                }
+            }
+        }
+        return res;
+    }
+    case Type::Expression: {
+        auto const &expression = _expressions.hot[i];
+        auto const name = _sets.hot[expression.extract].name;
+        if (expression.super != none) {
+            auto super = solve({Type::Expression, expression.super}, ctx);
+            if (!super.ok()) {
+                return set::create();
+            }
+            if (auto ex = super.extract(name); ex.ok()) {
+                return ex;
+            }
+        }
+        if (auto solve = this->solve({Type::Set, expression.extract}, ctx); solve.ok()) {
+            return solve;
+        }
+        Quiet<style::yellow>(), "undeclared set '", name.view(), "'\n";
+        ctx.sources.print(_sets.spans[expression.extract]);
+        return set::create();
+    }
+    case Type::Unary: {
+        // a chain of unaries, innermost first, as in digest
+        std::vector<uint32_t> chain{i};
+        while (_unaries.hot[chain.back()].operand.type() == Type::Unary) {
+            chain.push_back(_unaries.hot[chain.back()].operand.index());
+        }
+        auto v = solve(_unaries.hot[chain.back()].operand, ctx);
+        for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+            if (!v.ok()) {
+                return set::create();
+            }
+            v = extracted(builtin(ctx, unaries.at(_unaries.hot[*it].op)).apply(v));
+        }
+        return v;
+    }
+    case Type::Binary: {
+        // a chain of binaries down their lhs, each one applied to what the ones below it solved to
+        std::vector<uint32_t> chain{i};
+        while (_binaries.hot[chain.back()].lhs.type() == Type::Binary) {
+            chain.push_back(_binaries.hot[chain.back()].lhs.index());
+        }
+        auto x = solve(_binaries.hot[chain.back()].lhs, ctx);
+        for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+            if (!x.ok()) {
+                return set::create();
+            }
+            x = _solveBinary(*it, x, ctx);
+        }
+        return x;
+    }
+    case Type::Number: {
+        auto const constant = _numbers.hot[i].constant;
+        if (constant == none) return set::create();
+        if (auto const *integer = std::get_if<int64_t>(&_constants[constant])) return set::create<set::Int>(*integer);
+        return set::create<set::Float>(std::get<double>(_constants[constant]));
+    }
+    case Type::Bool: return set::create<set::Bool>(_bools.hot[i].value);
+    case Type::Void: return set::create<set::Void>();
+    default: return set::create();
+    }
 }
 
-void Binary::dump(size_t indent) const {
-    std::cout << std::string(indent * 2, ' ') << _op.show() << "\n";
-    _params->dump(indent + 1);
+set::Set Ast::_solveBinary(uint32_t binary, set::Set const &x, Context &ctx) const {
+    auto const &node = _binaries.hot[binary];
+    auto const y = solve(node.rhs, ctx);
+    if (!y.ok()) {
+        return set::create();
+    }
+    if (node.ref != none) {
+        auto params = set::create<set::Sets>();
+        params.cast<set::Sets>().add(symbol::x, x.clone().move());
+        params.cast<set::Sets>().add(symbol::y, y.clone().move());
+        if (auto local = solveWithParams(node.ref, std::move(params), ctx); local.ok()) {
+            return local.extract(symbol::extract);
+        }
+    }
+    return extracted(builtin(ctx, binaries.at(node.op)).apply(x, y));
 }
 
-void Fact::dump(size_t indent) const {
-    std::cout << std::string(indent * 2, ' ') << "fact\n";
-    if (_lvalue) _lvalue->dump(indent + 1);
-    if (_rvalue) _rvalue->dump(indent + 1);
+set::Set Ast::solveWithParams(uint32_t module, set::Set params, Context &ctx) const {
+    ctx.params.push(std::move(params));
+    auto slv = solve({Type::Module, module}, ctx);
+    ctx.params.pop();
+    return slv;
 }
 
-void Statements::dump(size_t indent) const {
-    for (auto const &s : _statements) {
-        s->dump(indent);
+set::Set Ast::_solve(std::span<uint32_t const> facts, Context &ctx) const {
+    auto sets = std::make_unique<set::Sets>();
+    for (auto const f : facts) {
+        auto const name = _sets.hot[_facts.hot[f].lvalue].name;
+        auto solve = this->solve({Type::Fact, f}, ctx);
+        if (!solve.ok()) {
+            return set::create();
+        }
+        bool ambiguous = !sets->add(name, solve.move());
+        if (ambiguous) {
+            Quiet<style::red>(), "'", name.view(), "' ambiguous\n";
+            ctx.sources.print(_facts.spans[f]);
+            return set::create();
+        }
     }
+    return {std::move(sets)};
 }
 
-void Module::dump(size_t indent) const {
-    std::cout << std::string(indent * 2, ' ') << "module " << getName() << "\n";
-    _stmts->dump(indent + 1);
-    for (auto const &m : _modules) {
-        m.second->dump(indent + 1);
+void Ast::dump(Ref node, size_t indent) const {
+    auto const i = node.index();
+    auto const pad = std::string(indent * 2, ' ');
+    switch (node.type()) {
+    case Type::List:
+        for (auto it = _open[i].rbegin(); it != _open[i].rend(); ++it) {
+            dump(*it, indent);
+        }
+        break;
+    case Type::Fact:
+        std::cout << pad << "fact\n";
+        dump({Type::Set, _facts.hot[i].lvalue}, indent + 1);
+        if (_facts.hot[i].rvalue) dump(_facts.hot[i].rvalue, indent + 1);
+        break;
+    case Type::Module:
+        std::cout << pad << "module " << _modules.hot[i].name.view() << "\n";
+        for (auto const f : _list(_modules.hot[i].facts)) {
+            dump({Type::Fact, f}, indent + 1);
+        }
+        for (auto const m : _list(_modules.hot[i].modules)) {
+            dump({Type::Module, m}, indent + 1);
+        }
+        break;
+    case Type::Set:
+        std::cout << pad << _sets.hot[i].name.view() << "\n";
+        for (auto const f : _list(_sets.hot[i].params)) {
+            dump({Type::Fact, f}, indent + 1);
+        }
+        break;
+    case Type::Expression: {
+        auto const &expression = _expressions.hot[i];
+        auto const super = expression.super != none;
+        std::cout << pad << "extract " << _sets.hot[expression.extract].name.view() << ": "
+                  << (super ? _sets.hot[_expressions.hot[expression.super].extract].name.view() : "?") << "\n";
+        dump({Type::Set, expression.extract}, indent + 1);
+        if (super) dump({Type::Expression, expression.super}, indent + 1);
+        break;
+    }
+    case Type::Unary:
+        std::cout << pad << _unaries.hot[i].op.show() << "\n";
+        if (_unaries.hot[i].operand) dump(_unaries.hot[i].operand, indent + 1);
+        break;
+    case Type::Binary:
+        std::cout << pad << _binaries.hot[i].op.show() << "\n";
+        for (auto const operand : {_binaries.hot[i].lhs, _binaries.hot[i].rhs}) {
+            if (operand) dump(operand, indent + 1);
+        }
+        break;
+    case Type::Number:
+    case Type::Bool:
+    case Type::Void: std::cout << pad << span(node) << "\n"; break;
+    default: break;
     }
-}
\ No newline at end of file
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include "set.h"
+#include "source.h"
 
 struct Kind {
     Kind(uint16_t kind) : _val(Value(kind)) {}
@@ -136,32 +137,21 @@ private:
 };
 
 struct Node {
-    struct Pos {
-        uint32_t line, column;
-    };
     std::string_view view;
     Node(std::string_view view) : view(view) {}
     std::string str() const { return std::string(view); }
-    std::pair<Pos, Pos> getRange(std::string const &str) const;
     Node combine(Node const &tail) const;
-    void printCode(std::string const &file) const;
+    void printCode(SourceManager const &sources) const { sources.print(view); }
 };
 
-class Context;
+struct Context;
 
 namespace node {
 
-class Fact;
-class Module;
-class Statements;
-
 struct Token : Node {
     Token(Kind kind, Node const &node);
     Token(Kind kind, std::string_view view);
     virtual ~Token() = default;
-    virtual Module const *digest(Context &ctx) { return (void)ctx, nullptr; }
-    virtual set::Set solve(Context &ctx) const { return (void)ctx, set::create(); }
-    set::Set solveWithParams(set::Set params, Context &ctx) const;
     virtual void dump(size_t indent = 0) const;
     template <typename T> T &cast() { return *static_cast<T *>(this); }
     template <typename T> T const &cast() const { return *static_cast<T const *>(this); }
@@ -169,170 +159,204 @@ struct Token : Node {
     Kind kind;
 };
 
+// lives in the parser's arena with its args, like the tokens of the cst
 struct Nonterm : Token {
     Nonterm(Kind kind);
-    void pushArgs(std::vector<std::unique_ptr<Token>> tokens);
-    std::vector<std::unique_ptr<Token>> args;
+    void pushArgs(std::span<Token *> tokens);
+    std::span<Token *> args;
     void dump(size_t indent = 0) const override;
     int size{};
 };
 
-template <typename Derived> struct BaseSet : Token {
-    BaseSet(Node node) : Token(Kind::Number, node) {}
-    BaseSet(std::string_view view) : Token(Kind::Number, view) {}
-    set::Set solve(Context &ctx) const override;
-    void dump(size_t indent = 0) const override { std::cout << std::string(indent * 2, ' ') << view << "\n"; }
+// the pools of the ast, a list holds statements while they are reduced, until a module or a set takes them
+enum class Type : uint8_t { None, List, Fact, Module, Set, Expression, Unary, Binary, Number, Bool, Void };
+
+// the most nodes of a type a ref can index
+constexpr uint32_t maxIndex = 0x0fffffff;
+
+// a node of the ast as its pool and its index in there, in 32 bits
+class Ref {
+public:
+    Ref() = default;
+    Ref(Type type, uint32_t index) : _bits(static_cast<uint32_t>(type) << 28 | index) {}
+    Type type() const { return static_cast<Type>(_bits >> 28); }
+    uint32_t index() const { return _bits & maxIndex; }
+    explicit operator bool() const { return _bits != 0; }
+
+private:
+    uint32_t _bits{};
 };
 
-struct Bool : BaseSet<Bool> {
-    using BaseSet::BaseSet;
-    using Set = set::Bool;
-    constexpr static auto name = "bool";
-    bool value() const { return view.compare("true") == 0; }
+// an index into a pool whose type is known, or none
+constexpr uint32_t none = ~uint32_t{};
+
+// consecutive indices in Ast::_lists
+struct Range {
+    uint32_t begin{}, size{};
 };
 
-struct Int : BaseSet<Int> {
-    using BaseSet::BaseSet;
-    using Set = set::Int;
-    constexpr static auto name = "int";
-    int value() const { return std::stoi(std::string(view)); }
+// what evaluating a node reads, the spans of source it came from are kept apart
+
+struct Fact {
+    uint32_t lvalue; // a set, naming the fact
+    Ref rvalue;
 };
 
-struct Void : BaseSet<Void> {
-    using BaseSet::BaseSet;
-    using Set = set::Void;
-    constexpr static auto name = "void";
+struct Module {
+    Symbol name;
+    Range facts;
+    Range modules; // by the id of their name, the first one of a name only
 };
 
-class Module : public Token {
-public:
-    struct Facts {
-        Facts(std::string name) : name(std::move(name)) {}
-        std::string name;
-        std::multimap<std::string_view, node::Fact *> facts;
-    };
-    using Modules = std::map<std::string_view, std::unique_ptr<Module>>;
+struct Set {
+    Symbol name;
+    Ref annotation;      // its superset
+    uint32_t ref = none; // the module it names, once digested
+    Range params;        // facts
+    Range facts;         // those it may extract, once digested
+};
 
-    Module(std::unique_ptr<Token> &&statements, Node const &node, std::string name);
-    Module(Modules &&modules);
-    Module const *digest(Context &ctx) override;
-    set::Set solve(Context &ctx) const override;
-    void dump(size_t indent = 0) const override;
-    void setName(std::string const &name);
-    void setName(std::string_view const &name);
-    std::string const &getName() const;
-    Facts getFacts() const;
-    set::Set genSet(set::Set const &param, Context &ctx) const;
-    Module const *find(std::string_view name) const;
-private:
-    std::unique_ptr<Statements> _stmts;
-    std::string _name;
-    Modules _modules;
+struct Expression {
+    uint32_t extract;      // a set
+    uint32_t super = none; // the expression it is extracted from
 };
 
-class Statements : public Token {
-public:
-    template <typename... T> Statements(T &&...init) : Token(Kind::Stmt, {}) { (..., pushBack(std::move(init))); }
-    Module const *digest(Context &ctx) override;
-    void pushFront(std::unique_ptr<Token> &&stmt);
-    void pushBack(std::unique_ptr<Token> &&stmt);
-    void dump(size_t indent = 0) const override;
-    set::Set solve(Context &ctx) const override;
-    std::deque<std::unique_ptr<Token>> const &get() const { return _statements; }
-private:
-    std::deque<std::unique_ptr<Token>> _statements;
-    friend Module::Module(std::unique_ptr<Token> &&, Node const &, std::string);
+// an operator holds its operands, evaluated in order and applied to the std set of its name
+struct Unary {
+    Kind op;
+    Ref operand;
 };
 
-struct Set : Token {
-    Set(std::string_view view, std::unique_ptr<Token> &&annotation = {}, std::unique_ptr<Token> &&params = {});
-    void setSuperset(std::unique_ptr<Token> &&set);
-    Token *getSuperset();
-    void setParams(std::unique_ptr<Token> &&params);
-    std::string value() const { return std::string(view); }
-    Module const *digest(Context &ctx) override;
-    set::Set solve(Context &ctx) const override;
-    void dump(size_t indent = 0) const override;
-    Module const *ref{};
-    std::vector<Fact const *> facts;
-private:
-    std::unique_ptr<Token> _annotation;
-    std::unique_ptr<Statements> _params;
+struct Binary {
+    Kind op;
+    Ref lhs, rhs;
+    uint32_t ref = none; // a module overloading the operator, it gets the operands as the facts x and y
 };
 
-class Expression : public Token {
-public:
-    Expression(std::unique_ptr<Token> &&extract, std::unique_ptr<Token> &&super);
-    Module const *digest(Context &ctx) override;
-    set::Set solve(Context &ctx) const override;
-    void dump(size_t indent = 0) const override;
-    void setExtract(std::unique_ptr<Token> &&extract);
-    void setSuperset(std::unique_ptr<Token> &&super);
-    std::string_view getExtractName() const;
-    Module const *getModule() const;
-private:
-    std::unique_ptr<Set> _extract;
-    std::unique_ptr<Expression> _super;
+// a literal decoded once as it is built, what it evaluates to is in Ast::_constants
+struct Number {
+    uint32_t constant;
 };
 
-class Unary : public Token {
-public:
-    Unary(Token const &op) : Token(Kind::Unary, op), _op(op.kind) {}
-    Module const *digest(Context &ctx) override;
-    set::Set solve(Context &ctx) const override;
-    void dump(size_t indent = 0) const override;
-    void setParam(std::unique_ptr<Token> &&param);
-    Module const *ref{};
-private:
-    static std::map<Kind, std::string_view> const table;
-    std::unique_ptr<Statements> _params;
-    Kind _op;
+using Constant = std::variant<int64_t, double>;
+
+// a literal that does not decode, ec is result_out_of_range if it is too large, invalid_argument if malformed
+struct BadNumber {
+    std::string_view view;
+    std::errc ec;
 };
 
-class Binary : public Token {
-public:
-    Binary(Token const &op) : Token(Kind::Binary, op), _op(op.kind) {}
-    Module const *digest(Context &ctx) override;
-    set::Set solve(Context &ctx) const override;
-    void dump(size_t indent = 0) const override;
-    void competedLhs(std::unique_ptr<Token> &&param);
-    void setLhs(std::unique_ptr<Token> &&param);
-    void setRhs(std::unique_ptr<Token> &&param);
-    Module const *ref{};
-private:
-    static std::map<Kind, std::string_view> const table;
-    std::unique_ptr<Statements> _params = std::make_unique<Statements>();
-    Binary *_binaryLhs{};
-    Kind _op;
+struct Bool {
+    bool value;
+};
+
+struct Void {};
+
+// the nodes of one type in a contiguous array, their spans in another one only diagnostics read
+template <typename Hot> struct Pool {
+    std::vector<Hot> hot;
+    std::vector<std::string_view> spans;
+    std::optional<std::string_view> overflow; // the span of the first node past what a ref can index
+
+    // once full the node is left out and kept as the overflow, the last one stands in for it
+    Ref add(Type type, Hot node, std::string_view span) {
+        if (hot.size() > maxIndex) {
+            if (!overflow) overflow = span;
+            return {type, maxIndex};
+        }
+        hot.push_back(node);
+        spans.push_back(span);
+        return {type, static_cast<uint32_t>(hot.size() - 1)};
+    }
+    size_t bytes() const { return hot.capacity() * sizeof(Hot) + spans.capacity() * sizeof(std::string_view); }
 };
 
-class Fact : public Token {
+// the ast of a program, built bottom up by the reductions of the parser, its nodes refer to each other by index
+// freed all at once with its pools, however deep it is
+class Ast {
 public:
-    Fact(std::unique_ptr<Token> &&lvalue, std::unique_ptr<Token> &&rvalue);
-    Module const *digest(Context &ctx) override;
-    set::Set solve(Context &ctx) const override;
-    void dump(size_t indent = 0) const override;
-    Set const &lvalue() const { return *_lvalue; }
-    Token const &rvalue() const { return *_rvalue; }
+    Ref set(std::string_view name);
+    Ref boolean(std::string_view view);
+    // a literal with a dot is a float, else an int, one out of range or malformed is kept in badNumbers()
+    Ref number(std::string_view view);
+    Ref empty(std::string_view view);
+    Ref fact(Ref lvalue, Ref rvalue);
+    // takes the statements of list, the modules among them become its submodules
+    // spans its statements unless it is written out in the source, the module of a file is not
+    Ref module(Ref list, std::string_view name, std::string_view span = {});
+    Ref expression(Ref extract, Ref super);
+    Ref unary(Kind op, std::string_view view);
+    Ref binary(Kind op, std::string_view view);
+    void setSuperset(Ref set, Ref annotation);
+    // takes the statements of list
+    void setParams(Ref set, Ref list);
+    void setOperand(Ref unary, Ref operand);
+    void setLhs(Ref binary, Ref lhs);
+    void setRhs(Ref binary, Ref rhs);
+    Ref list(Ref stmt);
+    void pushFront(Ref list, Ref stmt);
+    // moves the nodes of other over, the statements of its list others behind those of list, returns the list
+    Ref append(Ref list, Ast &&other, Ref others);
+
+    // the module node refers to, if any
+    uint32_t digest(Ref node, Context &ctx);
+    set::Set solve(Ref node, Context &ctx) const;
+    set::Set solveWithParams(uint32_t module, set::Set params, Context &ctx) const;
+    void dump(Ref node, size_t indent = 0) const;
+    std::string_view span(Ref node) const;
+    std::string_view name(uint32_t module) const { return _modules.hot[module].name.view(); }
+    // the literals that do not decode, the ast may not be evaluated while there are any
+    std::span<BadNumber const> badNumbers() const { return _badNumbers; }
+    // the first node left out of a pool that was full, the same holds while there is one
+    std::optional<std::string_view> overflow() const;
+    // the modules among the params of a set, which only takes facts, the same holds for them
+    std::span<std::string_view const> misplacedModules() const { return _misplacedModules; }
+    // what the nodes take, the unused capacity of the pools included
+    size_t nodes() const;
+    size_t bytes() const;
+    // the pools with their views as offsets into text, the names out of it carried along, empty if text is too long
+    std::string save(uint64_t key, std::string_view text, std::span<Ref const> roots) const;
+    // false if artifact was not saved under key from as many roots, or is damaged, the views then point into text
+    bool load(std::string_view artifact, uint64_t key, std::string_view text, std::span<Ref> roots);
+
 private:
-    std::unique_ptr<Set> _lvalue;
-    std::unique_ptr<Token> _rvalue;
+    uint32_t _find(uint32_t module, Symbol name) const;
+    // where value is in the constants, added if it is new
+    uint32_t _constant(Constant value);
+    set::Set _solve(std::span<uint32_t const> facts, Context &ctx) const;
+    // applies binary to x, the lhs solved, and its rhs
+    set::Set _solveBinary(uint32_t binary, set::Set const &x, Context &ctx) const;
+    std::span<uint32_t const> _list(Range range) const { return {_lists.data() + range.begin, range.size}; }
+    Range _take(Ref list, std::vector<uint32_t> *modules);
+
+    Pool<Fact> _facts;
+    Pool<Module> _modules;
+    Pool<Set> _sets;
+    Pool<Expression> _expressions;
+    Pool<Unary> _unaries;
+    Pool<Binary> _binaries;
+    Pool<Number> _numbers;
+    Pool<Bool> _bools;
+    Pool<Void> _voids;
+    std::vector<uint32_t> _lists; // the facts and submodules of modules, the params and facts of sets
+    std::vector<char> _names;     // what the views of a loaded ast not into its text point to
+    std::vector<Constant> _constants; // the values of the literals, each one once
+    // building only
+    std::vector<std::vector<Ref>> _open; // the statements of the lists not taken yet, last first
+    std::vector<uint32_t> _taken;        // lists to reuse
+    std::vector<uint32_t> _waiting; // of each binary, where its next lhs goes, a shortcut down a chain waiting for one
+    std::map<Constant, uint32_t> _pooled; // where each value is in _constants
+    std::vector<BadNumber> _badNumbers;
+    std::vector<std::string_view> _misplacedModules;
 };
 
 } // namespace node
 
 struct Context {
-    Context(std::string const &file);
+    Context(SourceManager const &sources);
     set::Set global;
     std::stack<set::Set> params;
-    std::stack<node::Module const *> scope;
-    std::string const &file;
+    std::stack<uint32_t> scope; // modules
+    std::map<Symbol, set::Set> builtins; // the sets of global looked up so far
+    SourceManager const &sources;
 };
-
-template <typename Derived> set::Set node::BaseSet<Derived>::solve(Context & /*ctx*/) const {
-    if constexpr (std::is_same_v<typename Derived::Set, set::Void>) {
-        return set::create<typename Derived::Set>();
-    } else {
-        return set::create<typename Derived::Set>(cast<Derived>().value());
-    }
-}
\ No newline at end of file
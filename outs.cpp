@@ -1,6 +1,7 @@
 #include "outs.h"
 
 Verbosity verbosity = Verbosity::Diagnostic;
+std::atomic<size_t> reported{};
 
 Verbosity getVerbosity() {
     return verbosity;
@@ -9,3 +10,11 @@ Verbosity getVerbosity() {
 void setVerbosity(Verbosity verbo){
     verbosity = verbo;
 }
+
+size_t reports() {
+    return reported.load(std::memory_order_relaxed);
+}
+
+void countReport() {
+    reported.fetch_add(1, std::memory_order_relaxed);
+}
@@ -20,10 +20,16 @@ enum class Verbosity { Quiet, Minimal, Normal, Detailed, Diagnostic };
 
 Verbosity getVerbosity();
 void setVerbosity(Verbosity verbo);
+// the pieces of red output so far, printed or not, a run that added none reported nothing
+size_t reports();
+void countReport();
 
 template <Verbosity V, StringLiteral Style> struct OutputTemplate {
     using self = OutputTemplate<V, Style>;
     self &operator,(auto &&out) {
+        if constexpr (std::string_view(Style.value) == style::red) {
+            countReport();
+        }
         if (getVerbosity() >= V) {
             if constexpr ((sizeof Style.value) > 1) {
                 std::cout << Style.value;
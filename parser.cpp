@@ -1,113 +1,227 @@
 #include "parser.h"
 #include "outs.h"
+#include "tokens.h"
 
 using namespace node;
 
-void Parser::setupGramma(CFG cfg, Kind root, Kind epsilon) {
+namespace {
+
+// the trace dumps walk the whole stacks, skip them unless they are shown
+bool tracing() {
+    return getVerbosity() >= Verbosity::Diagnostic;
+}
+
+// layout of a saved grammar, followed by the nonterminal flags, the table, the offsets and the symbols
+struct Artifact {
+    std::array<char, 8> magic;
+    uint64_t key;
+    uint32_t version, kinds, root, epsilon, offsets, symbols;
+};
+constexpr std::array<char, 8> artifactMagic{'s', 'i', 'm', 'p', 'l', 'l', 'l', '1'};
+// the table is cached under the grammar, not under the code building it: whenever what _makeSets or _makeTable
+// produce changes, this has to change with it, or an old artifact is loaded in place of the new table
+constexpr uint32_t artifactVersion = 2;
+
+} // namespace
+
+std::vector<Parser::Conflict> Parser::setupGramma(CFG cfg, Kind root, Kind epsilon) {
     reset();
 
     _cfg = std::move(cfg);
     _root = root;
     _epsilon = epsilon;
-    _stack.emplace(Kind::Eof);
-    _stack.emplace(_root);
+    restart();
 
     for (auto const &g : _cfg) {
         _nonterms[g.first.value()] = true;
     }
 
-    Diagn(), "\n> construct first sets\n";
-    _first = _makeFirstSets();
-    _dump(_first);
+    auto const lhs = _flatten();
+    _makeSets(lhs);
+    Diagn(), "\n> construct first and follow sets\n";
+    _dump();
     Diagn(), '\n';
+    return _makeTable(lhs);
+}
 
-    Diagn(), "> construct follow sets\n";
-    _follow = _makeFollowSets();
-    _dump(_follow);
-    Diagn(), '\n';
+std::string Parser::save(uint64_t key) const {
+    Artifact const head{artifactMagic,
+                        key,
+                        artifactVersion,
+                        Kind::Size,
+                        _root.value(),
+                        _epsilon.value(),
+                        static_cast<uint32_t>(_offsets.size()),
+                        static_cast<uint32_t>(_symbols.size())};
+    std::string res;
+    auto const append = [&res](void const *data, size_t size) { res.append(static_cast<char const *>(data), size); };
+    append(&head, sizeof head);
+    // a byte per flag, the representation of bool is up to the compiler
+    std::array<uint8_t, Kind::Size> nonterms{};
+    std::ranges::copy(_nonterms, nonterms.begin());
+    append(nonterms.data(), sizeof nonterms);
+    append(_table.data(), _table.size() * sizeof _table.front());
+    append(_offsets.data(), _offsets.size() * sizeof _offsets.front());
+    append(_symbols.data(), _symbols.size() * sizeof _symbols.front());
+    return res;
+}
 
-    Diagn(), "> solve reference\n";
-    for (auto const &pair : _cfg) {
-        _solveReference(pair.first);
+bool Parser::load(std::string_view artifact, uint64_t key) {
+    Artifact head;
+    if (artifact.size() < sizeof head) return false;
+    std::memcpy(&head, artifact.data(), sizeof head);
+    if (head.magic != artifactMagic || head.version != artifactVersion || head.kinds != Kind::Size || head.key != key) {
+        return false;
     }
-    _dump(_follow);
-    Diagn(), '\n';
+    auto const tableSize = size_t(Kind::Size) * Kind::Size;
+    std::array<uint8_t, Kind::Size> nonterms{};
+    auto const size = sizeof head + sizeof nonterms + tableSize * sizeof(int16_t) + head.offsets * sizeof(uint32_t) +
+                      head.symbols * sizeof(Kind);
+    if (artifact.size() != size || head.offsets == 0) return false;
+
+    reset();
+    auto const *at = artifact.data() + sizeof head;
+    auto const take = [&at](void *data, size_t size) {
+        std::memcpy(data, at, size);
+        at += size;
+    };
+    _root = static_cast<uint16_t>(head.root);
+    _epsilon = static_cast<uint16_t>(head.epsilon);
+    take(nonterms.data(), sizeof nonterms);
+    _table.resize(tableSize);
+    take(_table.data(), tableSize * sizeof _table.front());
+    _offsets.resize(head.offsets);
+    take(_offsets.data(), head.offsets * sizeof _offsets.front());
+    _symbols.assign(head.symbols, Kind::Invalid);
+    take(_symbols.data(), head.symbols * sizeof _symbols.front());
+
+    // a damaged artifact must not send the parser out of bounds
+    auto const productions = static_cast<int16_t>(head.offsets - 1);
+    bool const ok = std::ranges::all_of(nonterms, [](uint8_t flag) { return flag <= 1; }) &&
+                    _root.value() < Kind::Size && _epsilon.value() < Kind::Size && _offsets.front() == 0 &&
+                    _offsets.back() == head.symbols && std::ranges::is_sorted(_offsets) &&
+                    std::ranges::all_of(_symbols, [](Kind k) { return k.value() < Kind::Size; }) &&
+                    std::ranges::all_of(_table, [productions](int16_t a) { return a >= Reject && a < productions; });
+    if (!ok) {
+        reset();
+        return false;
+    }
+    std::ranges::copy(nonterms, _nonterms.begin());
+    restart();
+    return true;
 }
 
-void Parser::setRawText(std::string const &str) {
-    _text = &str;
+void Parser::setSources(SourceManager const &sources) {
+    _sources = &sources;
 }
 
-std::stack<std::unique_ptr<Token>> const &Parser::getCst() const {
+std::vector<Token *> const &Parser::getCst() const {
     return _cst;
 }
 
+void Parser::setReduce(Reduce reduce) {
+    _reduce = std::move(reduce);
+}
+
+std::vector<Parser::Value> &Parser::getValues() {
+    return _values;
+}
+
+void Parser::restart() {
+    _arena.reset();
+    _cst.clear();
+    _values.clear();
+    _pending.clear();
+    _stack.clear();
+    _stack.push_back({Kind::Eof, 0});
+    _stack.push_back({_root, 0});
+}
+
 void Parser::reset() {
     _root = Kind::Root;
     _epsilon = Kind::epsilon;
     _nonterms = {};
-    _cst = {};
-    _stack = {};
+    _table.clear();
+    _symbols.clear();
+    _offsets.clear();
+    restart();
+}
+
+void Parser::_shift(Kind kind, std::string_view view) {
+    if (_reduce) {
+        _values.push_back({kind, view, {}});
+    } else {
+        _cst.push_back(_arena.make<Token>(kind, view));
+    }
 }
 
 void Parser::_pop() {
-    auto &stack = _stack.top().stack;
-    while (!stack.empty()) {
-        auto count = stack.top()->cast<Nonterm>().size;
-        std::vector<std::unique_ptr<Token>> tmp;
-        for (auto i = 0; i < count; ++i) {
-            tmp.push_back(std::move(_cst.top()));
-            _cst.pop();
+    for (auto reduces = _stack.back().reduces; reduces > 0; --reduces) {
+        auto const [kind, size] = _pending.back();
+        _pending.pop_back();
+        if (tracing()) {
+            for (auto i = size; i > 0; --i) {
+                Diagn(), (_reduce ? _values.end()[-i].kind : _cst.end()[-i]->kind).show(), " ";
+            }
+            Diagn(), '\n';
         }
-        for (auto const &t : tmp | std::views::reverse) {
-            Diagn(), t->kind.show(), " ";
+        if (_reduce) {
+            auto const first = _values.end() - size;
+            auto const view = Node(first->view).combine(Node(_values.back().view)).view;
+            auto const ast = _reduce(kind, std::span(first, _values.end()));
+            _values.erase(first, _values.end());
+            _values.push_back({kind, view, ast});
+            continue;
         }
-        stack.top()->cast<Nonterm>().pushArgs(std::move(tmp));
-        _cst.push(std::move(stack.top()));
-        Diagn(), '\n';
-        stack.pop();
+        auto const first = _cst.end() - size;
+        auto const args = _arena.array<Token *>(size);
+        std::copy(first, _cst.end(), args.begin());
+        _cst.erase(first, _cst.end());
+        auto *nonterm = _arena.make<Nonterm>(kind);
+        nonterm->pushArgs(args);
+        _cst.push_back(nonterm);
     }
-    _stack.pop();
-};
+    _stack.pop_back();
+}
 
 int Parser::parse(Token const &input) {
-    if (input.kind == _epsilon || input.kind == Kind::Comment) return 0;
+    return _parse(input.kind, input.view);
+}
+
+int Parser::parse(TokenStream const &stream, uint32_t index) {
+    return _parse(stream.kind(index), stream.view(index));
+}
+
+int Parser::_parse(Kind kind, std::string_view view) {
+    if (kind == _epsilon || kind == Kind::Comment) return 0;
     int err{};
-    while (!_stack.empty() && !_isTerm(_stack.top().kind)) {
-        auto const &fiEle = _first[_stack.top().kind];
-        auto findrule = fiEle.find(input.kind);
-        if (findrule != fiEle.end()) {
-            auto rule = findrule->second;
-            Kind const grammaKind = _stack.top().kind;
-            auto const &gramma = _cfg.at(grammaKind);
-            auto top = std::move(_stack.top().stack);
-            _stack.pop();
+    while (!_stack.empty() && !_isTerm(_stack.back().kind)) {
+        Kind const grammaKind = _stack.back().kind;
+        auto const action = _table[grammaKind.value() * Kind::Size + kind.value()];
+        if (action >= 0) {
+            auto const *begin = _symbols.data() + _offsets[action];
+            auto const *end = _symbols.data() + _offsets[action + 1];
+            auto const reduces = _stack.back().reduces + 1;
+            _stack.pop_back();
             Diagn(), "⏪";
             _dump(_stack);
             Diagn(), "🔄️";
-            for (auto it = gramma[rule].rbegin(); it != gramma[rule].rend(); ++it) {
-                if (it == gramma[rule].rbegin()) {
-                    auto token = std::make_unique<Nonterm>(grammaKind);
-                    token->size = (int)gramma[rule].size();
-                    top.push(std::move(token));
-                    _stack.emplace(*it, std::move(top));
-                } else {
-                    _stack.emplace(*it);
-                }
+            _pending.push_back({grammaKind, static_cast<int>(end - begin)});
+            _stack.push_back({*--end, reduces});
+            while (end != begin) {
+                _stack.push_back({*--end, 0});
             }
             _dump(_stack);
-        } else if (fiEle.find(_epsilon) != fiEle.end()) {
-            if (_canfollow(_follow.find(_stack.top().kind)->second, input.kind)) {
-                _cst.push(std::make_unique<Token>(_epsilon, std::string_view{input.view.begin(), input.view.begin()}));
-                _pop();
-                Diagn(), "⏪";
-                _dump(_stack);
-            } else {
-                ++err;
-                Diagn(), "⏪";
-                // try to recover code here
-                break;
-            }
+        } else if (action == Vanish) {
+            _shift(_epsilon, view.substr(0, 0));
+            _pop();
+            Diagn(), "⏪";
+            _dump(_stack);
+        } else if (action == Unfollowed) {
+            ++err;
+            Diagn(), "⏪";
+            // try to recover code here
+            break;
         } else {
             ++err;
             Diagn(), "😖\n";
@@ -115,36 +229,47 @@ int Parser::parse(Token const &input) {
         }
     }
 
-    if (_isTerm(_stack.top().kind)) {
-        if (_stack.top().kind != input.kind) {
+    if (_isTerm(_stack.back().kind)) {
+        if (_stack.back().kind != kind) {
             ++err;
         } else {
             Diagn(), "⏪";
-            _cst.push(std::make_unique<Token>(input));
+            _shift(kind, view);
             _pop();
             _dump(_stack);
         }
     }
 
+    if (err > 0 && !_reporting) {
+        return err;
+    }
     if (err > 0) {
+        auto const top = _stack.back().kind;
         Quiet<style::red>(), "expected ";
-        if (_isTerm(_stack.top().kind)) {
-            Quiet<style::red>(), '\'', _stack.top().kind.show(), '\'';
-        }
-        for (auto const &ff : _first[_stack.top().kind]) {
-            Quiet<style::red>(), '\'', ff.first.show(), '\'', ' ';
+        if (_isTerm(top)) {
+            Quiet<style::red>(), '\'', top.show(), '\'';
+        } else {
+            for (uint16_t k{}; k < Kind::Size; ++k) {
+                if (_table[top.value() * Kind::Size + k] >= 0) {
+                    Quiet<style::red>(), '\'', Kind(k).show(), '\'', ' ';
+                }
+            }
         }
         Quiet(), '\n';
-        input.printCode(*_text);
+        if (_sources) Node(view).printCode(*_sources);
         return err;
     }
 
-    for (auto const &k : _cst._Get_container()) {
-        Diagn(), k->kind.show(), " ";
+    if (tracing()) {
+        for (auto const &k : _cst) {
+            Diagn(), k->kind.show(), " ";
+        }
+        for (auto const &v : _values) {
+            Diagn(), v.kind.show(), " ";
+        }
+        Diagn(), "\n";
+        Diagn(), "\n";
     }
-    Diagn(), "\n";
-
-    Diagn(), "\n";
     return err;
 }
 
@@ -152,195 +277,169 @@ bool Parser::_isTerm(Kind k) const {
     return !_nonterms[k.value()];
 }
 
-bool Parser::_isReference(FoKind k) const {
-    return !_isTerm(k.kind);
-}
-
-std::vector<Kind> Parser::_getTerm(Kind k) const {
-    if (_isTerm(k)) return {k};
-    std::vector<Kind> res;
-    for (auto const &vec : _cfg.at(k)) {
-        Kind front = vec.front();
-        if (front == k) {
-            Diagn(), "!left recursion: ", k.show(), "\n";
-            continue;
-        }
-        if (_isTerm(front)) {
-            res.push_back(front);
-        } else {
-            for (auto t : _getTerm(front)) {
-                res.push_back(t);
-            }
-        }
-    }
-    return res;
-}
-
-std::map<Kind, int> Parser::_makeFirstSet(Kind kind) const {
-    std::map<Kind, int> res;
-    auto const &gramma = _cfg.at(kind);
-    for (size_t i{}; i < gramma.size(); ++i) {
-        auto const &option = gramma[i];
-        auto addition = _getTerm(option.front());
-        for (auto a : addition) {
-            auto find = res.find(a);
-            if (find != res.end()) {
-                auto fi = find->first.show();
-                constexpr auto txt = "'input {} -> {}.rule[{}]' is replaced by 'input {} -> {}.rule[{}]'\n";
-                auto msg = std::format(txt, fi, kind.show(), find->second, a.show(), kind.show(), int(i));
-                Quiet<style::red>(), msg;
-                res.insert({a, int(i)});
-            } else {
-                res.insert({a, int(i)});
-            }
+std::vector<Kind> Parser::_flatten() {
+    std::vector<Kind> lhs;
+    _symbols.clear();
+    _offsets.assign(1, 0);
+    for (auto const &[k, options] : _cfg) {
+        for (auto const &option : options) {
+            _symbols.insert(_symbols.end(), option.begin(), option.end());
+            _offsets.push_back(static_cast<uint32_t>(_symbols.size()));
+            lhs.push_back(k);
         }
     }
-    return res;
-}
-
-void Parser::_followInsertEof(std::map<Kind, std::set<FoKind>> &res, Kind k) const {
-    if (_isTerm(k) || res[k].contains({Kind::Eof})) return;
-    res[k].insert({Kind::Eof});
-    for (auto const &option : _cfg.at(k)) {
-        _followInsertEof(res, option.back());
-    }
+    return lhs;
 }
 
-std::map<Kind, int> Parser::_makeFirstSet(CFG::const_reference pair) const {
-    return _makeFirstSet(pair.first);
+std::span<Kind const> Parser::_production(size_t p) const {
+    return std::span(_symbols).subspan(_offsets[p], _offsets[p + 1] - _offsets[p]);
 }
 
-std::map<Kind, std::map<Kind, int>> Parser::_makeFirstSets() const {
-    std::map<Kind, std::map<Kind, int>> res;
-    for (auto const &pair : _cfg) {
-        res[pair.first] = _makeFirstSet(pair);
+std::pair<Parser::Kinds, bool> Parser::_firstOf(std::span<Kind const> symbols) const {
+    Kinds first;
+    for (auto k : symbols) {
+        if (k == _epsilon) continue;
+        if (_isTerm(k)) return {first.set(k.value()), false};
+        first |= _first[k.value()];
+        if (!_nullable[k.value()]) return {first, false};
     }
-    return res;
+    return {first, true};
 }
 
-std::map<Kind, std::set<FoKind>> Parser::_makeFollowSet(CFG::const_reference b) const {
-    std::map<Kind, std::set<FoKind>> res;
-    for (auto const &option : b.second) {
-        for (auto target = option.begin(); target != option.end(); ++target) {
-            if (_isTerm(*target)) continue;
-
-            auto const beta = target + 1;
-
-            if (beta == option.end()) {
-                res[*target].insert({b.first});
-                continue;
-            }
-
-            if (_isTerm(*beta)) {
-                if (*beta != _epsilon) {
-                    res[*target].insert({*beta});
-                } else {
-                    res[*target].insert({b.first});
-                }
-            } else {
-                auto const &betaFirst = _first.at(*beta);
-                for (auto const &pair : betaFirst) {
-                    if (pair.first != _epsilon) {
-                        res[*target].insert({pair.first});
-                    }
-                }
-                if (std::ranges::any_of(betaFirst, [this](auto k) { return k.first == _epsilon; })) {
-                    res[*target].insert({b.first});
-                }
+void Parser::_makeSets(std::vector<Kind> const &lhs) {
+    auto const count = lhs.size();
+    // the productions to revisit when the sets of a nonterminal grow: those using it, and those defining it
+    std::vector<std::vector<uint32_t>> users(Kind::Size), definitions(Kind::Size);
+    for (uint32_t p{}; p < count; ++p) {
+        definitions[lhs[p].value()].push_back(p);
+        for (auto k : _production(p)) {
+            if (!_isTerm(k) && (users[k.value()].empty() || users[k.value()].back() != p)) {
+                users[k.value()].push_back(p);
             }
         }
     }
-
-    return res;
-}
-
-std::map<Kind, std::set<FoKind>> Parser::_makeFollowSets() const {
-    std::map<Kind, std::set<FoKind>> res;
-    _followInsertEof(res, _root);
-
-    for (auto const &pair : _cfg) {
-        auto fo = _makeFollowSet(pair);
-        for (const auto &addition : fo) {
-            auto &ref = res[addition.first];
-            for (FoKind k : addition.second) {
-                if (ref.contains(k)) {
-                    // auto msg = std::format("{} exists", k.kind.show());
-                    // Diagn(), "==", msg, "==\n";
-                    // _dump(res);
-                    // Diagn(), std::string(4 + msg.size(), '='), "\n";
-                } else {
-                    ref.insert(k);
-                }
-            }
+    for (auto const &[k, options] : _cfg) {
+        if (k != _root && users[k.value()].empty()) {
+            Quiet<style::yellow>(), "warn: unused symbol '", k.show(), "'\n";
         }
     }
-    return res;
-}
 
-void Parser::_solveReference(Kind k) {
-    auto find = _follow.find(k);
-    if (find == _follow.end()) {
-        _follow[k];
-        find = _follow.find(k);
-        Quiet<style::yellow>(), "warn: unused symbol '", k.show(), "'\n";
+    std::vector<uint32_t> work;
+    std::vector<bool> queued(count);
+    auto const schedule = [&](std::vector<uint32_t> const &productions) {
+        for (auto p : productions) {
+            if (!queued[p]) work.push_back(p), queued[p] = true;
+        }
+    };
+    auto const all = [&] {
+        work.resize(count);
+        std::iota(work.begin(), work.end(), 0U);
+        queued.assign(count, true);
+    };
+    auto const next = [&] {
+        auto const p = work.back();
+        work.pop_back();
+        queued[p] = false;
+        return p;
+    };
+
+    // first and nullable grow together, a production is revisited whenever a symbol it uses grows
+    _first.assign(Kind::Size, {});
+    _nullable.reset();
+    for (all(); !work.empty();) {
+        auto const p = next();
+        auto const a = lhs[p].value();
+        auto const [first, nullable] = _firstOf(_production(p));
+        if ((first & ~_first[a]).any() || (nullable && !_nullable[a])) {
+            _first[a] |= first;
+            _nullable[a] = _nullable[a] || nullable;
+            schedule(users[a]);
+        }
     }
-    auto &ref = find->second;
 
-    for (auto it = ref.begin(); it != ref.end();) {
-        if (_isReference(*it)) {
-            if (it->kind == k) {
-                Diagn(), std::format("!remove: Follow({}) = Follow({})\n", it->kind.show(), it->kind.show());
-                it = ref.erase(it);
+    // follow flows from a left hand side into its production, which is revisited when that grows
+    _follow.assign(Kind::Size, {});
+    _follow[_root.value()].set(Kind::Eof);
+    for (all(); !work.empty();) {
+        auto const p = next();
+        auto trailer = _follow[lhs[p].value()];
+        for (auto k : _production(p) | std::views::reverse) {
+            if (k == _epsilon) continue;
+            if (_isTerm(k)) {
+                trailer.reset().set(k.value());
                 continue;
             }
-            _solveReference(it->kind);
-            auto find = _follow.find(it->kind);
-            if (find == _follow.end()) {
-                Diagn(), std::format("cannot solve Follow({}) = Follow({})\n", k.show(), it->kind.show());
-                _dump(_follow);
-                exit(1);
+            auto &follow = _follow[k.value()];
+            if ((trailer & ~follow).any()) {
+                follow |= trailer;
+                schedule(definitions[k.value()]);
             }
-            ref.insert(find->second.begin(), find->second.end());
-            it = ref.erase(it);
-        } else {
-            ++it;
+            trailer = _nullable[k.value()] ? trailer | _first[k.value()] : _first[k.value()];
         }
     }
 }
 
-bool Parser::_canfollow(std::set<FoKind> const &foEle, Kind input) {
-    auto find = std::find_if(foEle.begin(), foEle.end(), [input](FoKind k) { return k.kind == input; });
-    return find != foEle.end();
-}
+std::vector<Parser::Conflict> Parser::_makeTable(std::vector<Kind> const &lhs) {
+    std::vector<Conflict> conflicts;
+    std::array<int16_t, Kind::Size> base{};
+    for (auto p = lhs.size(); p-- > 0;) {
+        base[lhs[p].value()] = static_cast<int16_t>(p);
+    }
+    auto const claim = [&](Kind nonterm, uint16_t input, int16_t action) {
+        auto &cell = _table[nonterm.value() * Kind::Size + input];
+        if (cell == Reject || cell == Unfollowed) {
+            cell = action;
+        } else if (cell != action) {
+            auto const rule = [&](int16_t a) { return a == Vanish ? -1 : a - base[nonterm.value()]; };
+            conflicts.push_back({nonterm, input, rule(cell), rule(action)});
+        }
+    };
 
-void Parser::_dump(std::map<Kind, std::map<Kind, int>> const &fi) {
-    for (auto const &pair : fi) {
-        Diagn(), "First(", pair.first.show(), ") = ", "{ ";
-        for (auto k : pair.second) {
-            Diagn(), std::format("{}[{}], ", k.first.show(), k.second);
+    _table.assign(Kind::Size * Kind::Size, Reject);
+    for (int16_t p{}; p < static_cast<int16_t>(lhs.size()); ++p) {
+        auto const [first, nullable] = _firstOf(_production(p));
+        for (uint16_t k{}; k < Kind::Size; ++k) {
+            if (first[k]) claim(lhs[p], k, p);
+        }
+        // never looked up, the epsilon column only names the way to derive nothing in syntax errors
+        if (nullable) claim(lhs[p], _epsilon.value(), p);
+    }
+    // a nonterminal that can derive nothing vanishes before what may follow it, into one epsilon token
+    for (auto const &[k, options] : _cfg) {
+        if (!_nullable[k.value()]) continue;
+        auto const row = _table.begin() + k.value() * Kind::Size;
+        std::replace(row, row + Kind::Size, int16_t(Reject), int16_t(Unfollowed));
+        for (uint16_t input{}; input < Kind::Size; ++input) {
+            if (_follow[k.value()][input]) claim(k, input, Vanish);
         }
-        Diagn(), "\b\b }\n";
     }
+
+    _first.clear();
+    _follow.clear();
+    return conflicts;
 }
 
-void Parser::_dump(std::map<Kind, std::set<FoKind>> const &fo) const {
-    for (auto const &pair : fo) {
-        Diagn(), "Follow(", pair.first.show(), ") = { ";
-        for (auto k : pair.second) {
-            if (_isReference(k)) {
-                Diagn(), "Follow(", k.kind.show(), "), ";
-            } else {
-                Diagn(), k.kind.show(), ", ";
-            }
+void Parser::_dump() const {
+    if (!tracing()) return;
+    auto const show = [](Kinds const &set) {
+        std::string res;
+        for (uint16_t k{}; k < Kind::Size; ++k) {
+            if (set[k]) res += (res.empty() ? "" : ", ") + Kind(k).show();
         }
-        Diagn(), (pair.second.empty() ? "\b}\n" : "\b\b }\n");
+        return res;
+    };
+    for (auto const &pair : _cfg) {
+        auto const k = pair.first.value();
+        Diagn(), "First(", pair.first.show(), ") = { ", show(_first[k]), _nullable[k] ? " } nullable\n" : " }\n";
+        Diagn(), "Follow(", pair.first.show(), ") = { ", show(_follow[k]), " }\n";
     }
 }
 
-void Parser::_dump(std::stack<Process> const &stack) {
+void Parser::_dump(std::vector<Frame> const &stack) {
+    if (!tracing()) return;
     Diagn(), " ";
-    for (auto const &[k, s] : stack._Get_container()) {
-        Diagn(), k.show(), (s.empty() ? "" : ('(' + s.top()->kind.show() + ')')), " ";
+    for (auto const &[k, reduces] : stack) {
+        Diagn(), k.show(), (reduces == 0 ? "" : std::format("({})", reduces)), " ";
     }
     Diagn(), "\n";
 }
@@ -1,54 +1,107 @@
 #pragma once
+#include "arena.h"
 #include "node.h"
 
-struct FoKind {
-    Kind kind;
-    auto operator<=>(FoKind const &rhs) const { return kind <=> rhs.kind; }
-};
-
-struct Process {
-    Process(Kind kind, std::stack<std::unique_ptr<node::Token>> stack = {}) : kind(kind), stack(std::move(stack)) {}
-    Kind kind;
-    std::stack<std::unique_ptr<node::Token>> stack;
-};
+class TokenStream;
 
 class Parser {
 public:
     using CFG = std::map<Kind, std::vector<std::vector<Kind>>>;
-    void setupGramma(CFG cfg, Kind root = Kind::Root, Kind epsilon = Kind::epsilon);
-    void setRawText(std::string const &str);
-    std::stack<std::unique_ptr<node::Token>> const &getCst() const;
+    using Kinds = std::bitset<Kind::Size>;
+
+    // an input two alternatives of nonterm claim, the first of them is kept
+    struct Conflict {
+        Kind nonterm, input;
+        int kept, dropped; // indices into the alternatives of nonterm, -1 when nonterm derives nothing
+    };
+
+    // table cells below zero, for inputs no production of the nonterminal starts with
+    enum Action : int16_t {
+        Vanish = -1, // the nonterminal derives epsilon and the input can follow it
+        Unfollowed = -2, // it derives epsilon but the input can not follow
+        Reject = -3,
+    };
+
+    // what a symbol reduced to, when the parser runs a reduce function in place of building the cst
+    struct Value {
+        Kind kind;
+        std::string_view view;
+        node::Ref ast; // none for terminals and epsilon
+    };
+    // builds the ast of a reduction of a nonterminal from the values of its children
+    using Reduce = std::function<node::Ref(Kind, std::span<Value>)>;
+
+    std::vector<Conflict> setupGramma(CFG cfg, Kind root = Kind::Root, Kind epsilon = Kind::epsilon);
+    // the parse table and productions built by setupGramma, tagged with key
+    std::string save(uint64_t key) const;
+    // restores what save wrote in place of setupGramma, false if the artifact is malformed or has another key
+    bool load(std::string_view artifact, uint64_t key);
+    void setSources(SourceManager const &sources);
+    // syntax errors are counted either way, shown only while reporting
+    void setReporting(bool reporting) { _reporting = reporting; }
+    // the finished subtrees, the whole tree once the input is parsed, valid until restart
+    std::vector<node::Token *> const &getCst() const;
+    // with a reduce function the parser reduces into values instead, and no cst is built
+    void setReduce(Reduce reduce);
+    // like the cst, the finished values
+    std::vector<Value> &getValues();
     int parse(node::Token const &input);
+    int parse(TokenStream const &stream, uint32_t index);
+    // drops the cst at once and starts over with the same grammar
+    void restart();
     void reset();
 
+    // the grammar as set up, for generating parsers from it
+    Kind getRoot() const { return _root; }
+    Kind getEpsilon() const { return _epsilon; }
+    bool isNonterm(Kind k) const { return !_isTerm(k); }
+    // the production to expand nonterm by on input, or an action
+    int lookup(Kind nonterm, Kind input) const { return _table[nonterm.value() * Kind::Size + input.value()]; }
+    std::span<Kind const> getProduction(int p) const { return _production(p); }
+
 private:
+    struct Frame {
+        Kind kind;
+        uint32_t reduces; // the pending nonterminals this symbol completes, this one last
+    };
+    struct Pending {
+        Kind kind;
+        int size;
+    };
+
+    int _parse(Kind kind, std::string_view view);
+    void _shift(Kind kind, std::string_view view);
     void _pop();
     bool _isTerm(Kind k) const;
-    bool _isReference(FoKind k) const;
-    std::vector<Kind> _getTerm(Kind k) const;
-
-    std::map<Kind, int> _makeFirstSet(Kind kind) const;
-    std::map<Kind, int> _makeFirstSet(CFG::const_reference pair) const;
-    std::map<Kind, std::map<Kind, int>> _makeFirstSets() const;
 
-    void _followInsertEof(std::map<Kind, std::set<FoKind>> &res, Kind k) const;
-    std::map<Kind, std::set<FoKind>> _makeFollowSet(CFG::const_reference b) const;
-    std::map<Kind, std::set<FoKind>> _makeFollowSets() const;
-    void _solveReference(Kind k);
-    static bool _canfollow(std::set<FoKind> const &foEle, Kind input);
+    std::vector<Kind> _flatten();
+    std::span<Kind const> _production(size_t p) const;
+    std::pair<Kinds, bool> _firstOf(std::span<Kind const> symbols) const;
+    void _makeSets(std::vector<Kind> const &lhs);
+    std::vector<Conflict> _makeTable(std::vector<Kind> const &lhs);
 
-    static void _dump(std::map<Kind, std::map<Kind, int>> const &fi);
-    void _dump(std::map<Kind, std::set<FoKind>> const &fo) const;
-    static void _dump(std::stack<Process> const &stack);
+    void _dump() const;
+    static void _dump(std::vector<Frame> const &stack);
 
 private:
     Kind _root{Kind::Root};
     Kind _epsilon{Kind::epsilon};
     std::array<bool, Kind::Size> _nonterms;
-    std::map<Kind, std::map<Kind, int>> _first;
-    std::map<Kind, std::set<FoKind>> _follow;
+    // only while setting up, indexed by nonterminal
+    std::vector<Kinds> _first, _follow;
+    Kinds _nullable;
     CFG _cfg;
-    std::stack<std::unique_ptr<node::Token>> _cst;
-    std::stack<Process> _stack;
-    std::string const *_text;
+    // dense ll(1) table, _table[nonterm * Kind::Size + input] is a production index or an action
+    std::vector<int16_t> _table;
+    // right hand sides back to back, production p is _symbols[_offsets[p], _offsets[p + 1])
+    std::vector<Kind> _symbols;
+    std::vector<uint32_t> _offsets;
+    Arena _arena; // holds the cst
+    std::vector<node::Token *> _cst;
+    Reduce _reduce;
+    std::vector<Value> _values;
+    std::vector<Pending> _pending; // expanded, waiting for their children, the innermost last
+    std::vector<Frame> _stack;
+    SourceManager const *_sources{}; // where syntax errors are shown, if set
+    bool _reporting{true};
 };
@@ -1,17 +1,32 @@
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <bit>
+#include <bitset>
+#include <charconv>
+#include <chrono>
 #include <cmath>
+#include <cstring>
 #include <deque>
+#include <filesystem>
 #include <format>
 #include <fstream>
+#include <functional>
 #include <iostream>
+#include <limits>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <numeric>
 #include <optional>
+#include <random>
 #include <ranges>
 #include <set>
+#include <span>
 #include <sstream>
 #include <stack>
 #include <string>
 #include <string_view>
+#include <thread>
+#include <variant>
 #include <vector>
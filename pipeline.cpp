@@ -0,0 +1,120 @@
+#include "pipeline.h"
+#include "ast.h"
+#include "outs.h"
+#include "ring.h"
+#include "tokens.h"
+
+namespace {
+
+struct Lexed {
+    uint16_t kind;
+    uint32_t offset, length;
+};
+
+// tokens per hand over, large enough that the ring is touched rarely
+constexpr size_t batchSize = 512;
+
+// parts per thread, so threads finishing early take over the rest
+constexpr size_t partsPerJob = 4;
+
+// the token ranges between top-level commas closest to even splits, the eof left out
+std::vector<std::pair<uint32_t, uint32_t>> splitTopLevel(TokenStream const &stream, size_t parts) {
+    std::vector<std::pair<uint32_t, uint32_t>> res;
+    auto const eof = stream.size() - 1;
+    uint32_t begin{};
+    auto const kind = [&stream](size_t i) { return stream.kind(static_cast<uint32_t>(i)); };
+    topLevelCommas(eof, kind, [&](size_t i) {
+        if (i >= uint64_t{eof} * (res.size() + 1) / parts) {
+            res.emplace_back(begin, static_cast<uint32_t>(i));
+            begin = static_cast<uint32_t>(i + 1);
+        }
+    });
+    res.emplace_back(begin, eof);
+    return res;
+}
+
+} // namespace
+
+int parsePipelined(Parser &parser, std::string_view str, token::Dfa const &dfa, bool &finished) {
+    SpscRing<std::vector<Lexed>, 16> ring;
+
+    std::jthread lexing([&] {
+        auto const lexed = [str](Kind kind, std::string_view view) {
+            return Lexed{kind.value(), static_cast<uint32_t>(view.data() - str.data()), static_cast<uint32_t>(view.size())};
+        };
+        // undefined input travels with the tokens, so it is reported in order with the syntax errors
+        std::vector<std::string_view> rejected;
+        Lexer lexer(str);
+        lexer.collectRejects(&rejected);
+        for (bool eof = false; !eof; ring.push()) {
+            auto &batch = ring.back();
+            batch.clear();
+            while (!eof && batch.size() < batchSize) {
+                auto const token = lexer.next(dfa);
+                for (auto const &view : rejected) {
+                    batch.push_back(lexed(Kind::Invalid, view));
+                }
+                rejected.clear();
+                if (token.kind != Kind::Comment) batch.push_back(lexed(token.kind, token.view));
+                eof = token.kind == Kind::Eof;
+            }
+        }
+    });
+
+    int err{};
+    for (bool eof = false; !eof; ring.pop()) {
+        for (auto const &token : ring.front()) {
+            auto const view = str.substr(token.offset, token.length);
+            if (token.kind == Kind::Invalid) {
+                Lexer::printUndefined(view);
+                continue;
+            }
+            Diagn(), "== ", Kind(token.kind).name(), " ", view, " ==\n";
+            err += parser.parse(node::Token(token.kind, view));
+            eof = token.kind == Kind::Eof;
+            if (eof) finished = Lexer::finished(node::Token(token.kind, view));
+        }
+    }
+    return err;
+}
+
+node::Ref parseParallel(Parser const &parser, TokenStream const &stream, unsigned jobs, node::Ast &ast) {
+    auto const parts = splitTopLevel(stream, size_t{jobs} * partsPerJob);
+    auto const grammar = parser.save(0);
+    std::vector<node::Ast> asts(parts.size());
+    std::vector<node::Ref> roots(parts.size());
+    std::atomic<size_t> next{};
+    std::atomic<int> err{};
+    {
+        std::vector<std::jthread> threads;
+        for (unsigned i{}; i < jobs; ++i) {
+            threads.emplace_back([&] {
+                Parser worker;
+                worker.load(grammar, 0);
+                worker.setReporting(false);
+                for (size_t part; err == 0 && (part = next++) < parts.size(); worker.restart()) {
+                    auto const [begin, end] = parts[part];
+                    worker.setReduce(reduceInto(asts[part]));
+                    int e{};
+                    for (auto at = begin; at < end; ++at) {
+                        e += worker.parse(stream, at);
+                    }
+                    // a part ending at a comma ends there as the whole input would
+                    e += end + 1 == stream.size() ? worker.parse(stream, end)
+                                                  : worker.parse(node::Token(Kind::Eof, stream.view(end).substr(0, 0)));
+                    if (e > 0) {
+                        err += e;
+                    } else {
+                        roots[part] = worker.getValues().front().ast;
+                    }
+                }
+            });
+        }
+    }
+    if (err > 0) return {};
+    node::Ref res;
+    for (size_t part{}; part < parts.size(); ++part) {
+        res = ast.append(res, std::move(asts[part]), roots[part]);
+    }
+    return res;
+}
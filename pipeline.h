@@ -0,0 +1,16 @@
+#pragma once
+#include "lexer.h"
+#include "parser.h"
+
+class TokenStream;
+
+// lexes on a second thread while the calling thread parses, returns the syntax errors
+// tokens are handed over in batches through a bounded ring, so a slow parser stalls the lexer
+// finished is false if the input ended in the middle of a token, see Lexer::finished
+int parsePipelined(Parser &parser, std::string_view str, token::Dfa const &dfa, bool &finished);
+
+// parses a pre-lexed input split at its top-level commas on jobs threads, joining the asts in source order
+// every thread has a parser of its own with the grammar of parser, restarted for each part it takes
+// the statements of the whole input, their nodes moved into ast one part after the other
+// nothing on syntax errors, which are not shown, a sequential parse reports them in order
+node::Ref parseParallel(Parser const &parser, TokenStream const &stream, unsigned jobs, node::Ast &ast);
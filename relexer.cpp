@@ -0,0 +1,215 @@
+#include "relexer.h"
+
+namespace {
+
+// the part of the fenwick tree node i sums up, and the step to the next one covering it
+size_t lowest(size_t i) {
+    return i & (~i + 1);
+}
+
+// of the first count values
+size_t sum(std::vector<size_t> const &tree, size_t count) {
+    size_t res{};
+    for (auto i = count; i > 0; i -= lowest(i)) {
+        res += tree[i];
+    }
+    return res;
+}
+
+// wraps around when it shrinks, so does the sum
+void add(std::vector<size_t> &tree, size_t index, size_t delta) {
+    for (auto i = index + 1; i < tree.size(); i += lowest(i)) {
+        tree[i] += delta;
+    }
+}
+
+} // namespace
+
+Relexer::Relexer(token::Dfa const &dfa, std::string_view text) : _dfa(dfa) {
+    std::string const window(text);
+    std::vector<Token> tokens;
+    size_t replaced{};
+    _relex(window, true, 0, std::numeric_limits<uint32_t>::max(), 0, {}, tokens, replaced);
+    _chunks = _split(window, tokens, (tokens.size() + _chunkSize - 1) / _chunkSize);
+    _index();
+}
+
+std::string Relexer::text() const {
+    std::string res;
+    res.reserve(length());
+    for (auto const &chunk : _chunks) {
+        res += chunk.text;
+    }
+    return res;
+}
+
+size_t Relexer::length() const {
+    return sum(_lengths, _chunks.size());
+}
+
+size_t Relexer::size() const {
+    return sum(_counts, _chunks.size());
+}
+
+std::vector<Relexer::Token> Relexer::tokens(size_t first, size_t last) const {
+    std::vector<Token> res;
+    auto [c, entry] = _locate(_counts, first);
+    auto base = static_cast<uint32_t>(sum(_lengths, c));
+    for (res.reserve(last - first); res.size() < last - first; ++entry) {
+        if (entry == _chunks[c].entries.size()) {
+            base += static_cast<uint32_t>(_chunks[c++].text.size());
+            entry = 0;
+        }
+        auto const &e = _chunks[c].entries[entry];
+        res.push_back({e.kind, base + e.begin, base + e.begin + e.length});
+    }
+    return res;
+}
+
+size_t Relexer::find(size_t offset) const {
+    auto const [c, at] = _locate(_lengths, offset);
+    auto const &entries = _chunks[c].entries;
+    auto const it = std::ranges::partition_point(entries, [at](Entry const &e) { return e.begin < at; });
+    return sum(_counts, c) + static_cast<size_t>(it - entries.begin());
+}
+
+Relexer::Change Relexer::edit(size_t offset, size_t erase, std::string_view insert) {
+    auto const delta = static_cast<int64_t>(insert.size()) - static_cast<int64_t>(erase);
+    // the chunk holding the character before the edit, one a token ending before the edit is in
+    auto const first = offset == 0 ? 0 : _locate(_lengths, offset - 1).first;
+    auto const start = sum(_lengths, first);
+    auto last = std::max(first, _locate(_lengths, offset + erase).first);
+    std::string window;
+    std::vector<Token> old, fresh;
+    size_t replaced{};
+    for (;;) {
+        window.clear();
+        old.clear();
+        for (auto c = first; c <= last; ++c) {
+            auto const base = static_cast<uint32_t>(window.size());
+            for (auto const &e : _chunks[c].entries) {
+                old.push_back({e.kind, base + e.begin, base + e.begin + e.length});
+            }
+            window += _chunks[c].text;
+        }
+        window.replace(offset - start, erase, insert);
+        // the lexer was between tokens after one ending before the edit, the character after it is unchanged
+        auto const kept = static_cast<size_t>(
+            std::ranges::partition_point(old, [&](Token const &t) { return t.end < offset - start; }) - old.begin());
+        auto const editEnd = static_cast<uint32_t>(offset - start + insert.size());
+        if (_relex(window, last + 1 == _chunks.size(), kept, editEnd, delta, old, fresh, replaced)) break;
+        // a token running on past the chunks taken in, twice as many of them
+        last = std::min(_chunks.size() - 1, last + (last + 1 - first));
+    }
+
+    auto merged = fresh;
+    for (auto i = replaced; i < old.size(); ++i) {
+        auto const &t = old[i];
+        merged.push_back({t.kind, static_cast<uint32_t>(t.begin + delta), static_cast<uint32_t>(t.end + delta)});
+    }
+    // the tokens before the edit may come out of the lexer as they were
+    size_t same{};
+    while (same < fresh.size() && same < replaced && fresh[same] == old[same] && fresh[same].end <= offset - start) {
+        ++same;
+    }
+    Change const res{sum(_counts, first) + same, replaced - same, fresh.size() - same};
+
+    // the chunks keep their number while they stay within twice the usual size, the trees are then updated in place
+    auto const count = last + 1 - first;
+    auto const fits = merged.size() >= count && merged.size() <= count * 2 * _chunkSize;
+    auto chunks = _split(window, merged, fits ? count : (merged.size() + _chunkSize - 1) / _chunkSize);
+    if (fits) {
+        for (size_t i{}; i < count; ++i) {
+            auto &chunk = _chunks[first + i];
+            add(_lengths, first + i, chunks[i].text.size() - chunk.text.size());
+            add(_counts, first + i, chunks[i].entries.size() - chunk.entries.size());
+            chunk = std::move(chunks[i]);
+        }
+    } else {
+        auto const at = _chunks.erase(_chunks.begin() + static_cast<ptrdiff_t>(first),
+                                      _chunks.begin() + static_cast<ptrdiff_t>(last + 1));
+        _chunks.insert(at, std::make_move_iterator(chunks.begin()), std::make_move_iterator(chunks.end()));
+        _index();
+    }
+    return res;
+}
+
+bool Relexer::_relex(std::string const &window, bool rest, size_t kept, uint32_t editEnd, int64_t delta,
+                     std::vector<Token> const &old, std::vector<Token> &fresh, size_t &replaced) const {
+    fresh.assign(old.begin(), old.begin() + static_cast<ptrdiff_t>(kept));
+    auto const token = [&window](Kind kind, std::string_view view) {
+        auto const begin = static_cast<uint32_t>(view.data() - window.data());
+        return Token{kind, begin, begin + static_cast<uint32_t>(view.size())};
+    };
+    std::vector<std::string_view> rejected;
+    Lexer lexer(window);
+    lexer.collectRejects(&rejected);
+    if (kept > 0) lexer.seek(old[kept - 1].end);
+    auto o = kept;
+    for (;;) {
+        auto const next = lexer.next(_dfa);
+        for (auto const view : rejected) {
+            fresh.push_back(token(Kind::Invalid, view));
+        }
+        rejected.clear();
+        fresh.push_back(token(next.kind, next.view));
+        // the lexer looked at the sentinel after window, not at the text that follows
+        if (!rest && (next.kind == Kind::Eof || fresh.back().end >= window.size())) return false;
+        if (next.kind == Kind::Eof) {
+            replaced = old.size();
+            return true;
+        }
+        if (fresh.back().end < editEnd) continue;
+        // behind the edit the text is the old one, from a boundary both streams have on they are the same
+        auto const target = static_cast<int64_t>(fresh.back().end) - delta;
+        while (o < old.size() && old[o].end < target) {
+            ++o;
+        }
+        if (o < old.size() && old[o].end == target && old[o].kind != Kind::Eof) {
+            replaced = o + 1;
+            return true;
+        }
+    }
+}
+
+std::vector<Relexer::Chunk> Relexer::_split(std::string const &window, std::vector<Token> const &tokens, size_t count) {
+    std::vector<Chunk> res(count);
+    uint32_t from{};
+    for (size_t i{}; i < count; ++i) {
+        auto const begin = tokens.size() * i / count, end = tokens.size() * (i + 1) / count;
+        auto const to = i + 1 == count ? static_cast<uint32_t>(window.size()) : tokens[end - 1].end;
+        res[i].text = window.substr(from, to - from);
+        for (auto k = begin; k < end; ++k) {
+            res[i].entries.push_back({tokens[k].kind, tokens[k].begin - from, tokens[k].end - tokens[k].begin});
+        }
+        from = to;
+    }
+    return res;
+}
+
+void Relexer::_index() {
+    // linear fenwick construction, every node passes its sum on to its parent
+    _lengths.assign(_chunks.size() + 1, 0);
+    _counts.assign(_chunks.size() + 1, 0);
+    for (size_t i = 1; i <= _chunks.size(); ++i) {
+        _lengths[i] += _chunks[i - 1].text.size();
+        _counts[i] += _chunks[i - 1].entries.size();
+        if (auto const parent = i + lowest(i); parent <= _chunks.size()) {
+            _lengths[parent] += _lengths[i];
+            _counts[parent] += _counts[i];
+        }
+    }
+}
+
+std::pair<size_t, size_t> Relexer::_locate(std::vector<size_t> const &tree, size_t value) const {
+    // the most chunks whose values together are at most value
+    size_t count{}, rest = value;
+    for (auto step = std::bit_floor(_chunks.size()); step > 0; step >>= 1) {
+        if (count + step <= _chunks.size() && tree[count + step] <= rest) {
+            count += step;
+            rest -= tree[count];
+        }
+    }
+    if (count < _chunks.size()) return {count, rest};
+    return {_chunks.size() - 1, value - sum(tree, _chunks.size() - 1)}; // the end
+}
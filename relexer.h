@@ -0,0 +1,59 @@
+#pragma once
+#include "lexer.h"
+
+// keeps the token stream of a text and re-lexes only around edits
+// the text is held in chunks along with their tokens, an edit rewrites the chunks it relexed and finds the others
+// through fenwick trees over their sizes, it takes time in the size of the change and the log of the chunks
+class Relexer {
+public:
+    struct Token {
+        Kind kind; // undefined input is kept as Kind::Invalid, the comments as they are
+        uint32_t begin, end;
+        bool operator==(Token const &) const = default;
+    };
+    // tokens [first, first + removed) of the old stream are replaced by [first, first + inserted)
+    struct Change {
+        size_t first, removed, inserted;
+    };
+
+    Relexer(token::Dfa const &dfa, std::string_view text);
+    Change edit(size_t offset, size_t erase, std::string_view insert);
+    // copied together from the chunks
+    std::string text() const;
+    size_t length() const;
+    // the last token is always the eof with the rest the lexer could not finish
+    size_t size() const;
+    Token at(size_t index) const { return tokens(index, index + 1).front(); }
+    std::vector<Token> tokens(size_t first, size_t last) const;
+    // the index of the first token beginning at or after offset
+    size_t find(size_t offset) const;
+
+private:
+    struct Entry {
+        Kind kind;
+        uint32_t begin, length; // begin in the text of the chunk
+    };
+    // from the end of the last token of the chunk before to the end of its own last one
+    struct Chunk {
+        std::string text;
+        std::vector<Entry> entries;
+    };
+
+    // lexes window, the text from the start of a chunk, until its tokens end where an old one did behind editEnd
+    // the first kept old tokens are taken over, it lexes from the end of the last of them
+    // false if it runs into the end of window first, which is only the end of the input if rest
+    bool _relex(std::string const &window, bool rest, size_t kept, uint32_t editEnd, int64_t delta,
+                std::vector<Token> const &old, std::vector<Token> &fresh, size_t &replaced) const;
+    // tokens of window in count chunks of about the same number of them
+    static std::vector<Chunk> _split(std::string const &window, std::vector<Token> const &tokens, size_t count);
+    void _index();
+    // the chunk value falls into by one of the trees, and what is left of value in it
+    std::pair<size_t, size_t> _locate(std::vector<size_t> const &tree, size_t value) const;
+
+private:
+    static constexpr size_t _chunkSize = 128;
+
+    token::Dfa const &_dfa;
+    std::vector<Chunk> _chunks;
+    std::vector<size_t> _lengths, _counts; // fenwick trees from 1 over the sizes of the texts and of the tokens
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+// bounded lock free queue between one producer and one consumer thread
+// slots are filled and drained in place, so their buffers are reused
+// a full ring blocks the producer and an empty one the consumer
+template <typename T, size_t Capacity> class SpscRing {
+    static_assert(std::has_single_bit(Capacity));
+
+public:
+    // producer: the slot to fill next
+    T &back() {
+        auto const tail = _tail.load(std::memory_order_relaxed);
+        while (tail - _headCache == Capacity) {
+            _head.wait(_headCache, std::memory_order_acquire);
+            _headCache = _head.load(std::memory_order_acquire);
+        }
+        return _slots[tail & (Capacity - 1)];
+    }
+    // producer: hand the slot from back() over
+    void push() {
+        _tail.store(_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        _tail.notify_one();
+    }
+
+    // consumer: the oldest filled slot
+    T &front() {
+        auto const head = _head.load(std::memory_order_relaxed);
+        while (head == _tailCache) {
+            _tail.wait(_tailCache, std::memory_order_acquire);
+            _tailCache = _tail.load(std::memory_order_acquire);
+        }
+        return _slots[head & (Capacity - 1)];
+    }
+    // consumer: give the slot from front() back
+    void pop() {
+        _head.store(_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        _head.notify_one();
+    }
+
+private:
+    // each side caches the other's index and only rereads it when it looks full or empty
+    alignas(64) std::atomic<size_t> _head{};
+    size_t _tailCache{};
+    alignas(64) std::atomic<size_t> _tail{};
+    size_t _headCache{};
+    alignas(64) std::array<T, Capacity> _slots{};
+};
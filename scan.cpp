@@ -0,0 +1,356 @@
+#include "scan.h"
+#include "lexer.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define SIMPL_X86
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define SIMPL_AVX2
+#else
+#define SIMPL_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace {
+
+#ifdef SIMPL_X86
+__m128i range(__m128i v, char lo, char hi) {
+    return _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(char(lo - 1))), _mm_cmpgt_epi8(_mm_set1_epi8(char(hi + 1)), v));
+}
+
+SIMPL_AVX2 __m256i range(__m256i v, char lo, char hi) {
+    return _mm256_and_si256(
+        _mm256_cmpgt_epi8(v, _mm256_set1_epi8(char(lo - 1))), _mm256_cmpgt_epi8(_mm256_set1_epi8(char(hi + 1)), v)
+    );
+}
+#endif
+
+struct Spaces {
+    static bool in(char ch, char /*arg*/) { return token::isSpace(ch); }
+#ifdef SIMPL_X86
+    static __m128i in(__m128i v, __m128i /*arg*/) {
+        auto const blank = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\t')));
+        auto const eol = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\r')));
+        return _mm_or_si128(blank, eol);
+    }
+    SIMPL_AVX2 static __m256i in(__m256i v, __m256i /*arg*/) {
+        auto const blank =
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t')));
+        auto const eol =
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r')));
+        return _mm256_or_si256(blank, eol);
+    }
+#endif
+};
+
+struct Body {
+    static bool in(char ch, char /*arg*/) { return token::isBody(ch); }
+#ifdef SIMPL_X86
+    static __m128i in(__m128i v, __m128i /*arg*/) {
+        auto const alpha = range(_mm_or_si128(v, _mm_set1_epi8(0x20)), 'a', 'z'); // fold the case
+        auto const underscore = _mm_cmpeq_epi8(v, _mm_set1_epi8('_'));
+        auto const utf8 = _mm_cmplt_epi8(v, _mm_setzero_si128());
+        return _mm_or_si128(_mm_or_si128(alpha, range(v, '0', '9')), _mm_or_si128(underscore, utf8));
+    }
+    SIMPL_AVX2 static __m256i in(__m256i v, __m256i /*arg*/) {
+        auto const alpha = range(_mm256_or_si256(v, _mm256_set1_epi8(0x20)), 'a', 'z');
+        auto const underscore = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_'));
+        auto const utf8 = _mm256_cmpgt_epi8(_mm256_setzero_si256(), v);
+        return _mm256_or_si256(_mm256_or_si256(alpha, range(v, '0', '9')), _mm256_or_si256(underscore, utf8));
+    }
+#endif
+};
+
+struct Number {
+    static bool in(char ch, char /*arg*/) { return token::isDigit(ch) || ch == '.'; }
+#ifdef SIMPL_X86
+    static __m128i in(__m128i v, __m128i /*arg*/) {
+        return _mm_or_si128(range(v, '0', '9'), _mm_cmpeq_epi8(v, _mm_set1_epi8('.')));
+    }
+    SIMPL_AVX2 static __m256i in(__m256i v, __m256i /*arg*/) {
+        return _mm256_or_si256(range(v, '0', '9'), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('.')));
+    }
+#endif
+};
+
+struct Until {
+    static bool in(char ch, char arg) { return ch != arg; }
+#ifdef SIMPL_X86
+    static __m128i in(__m128i v, __m128i arg) { return _mm_xor_si128(_mm_cmpeq_epi8(v, arg), _mm_set1_epi8(-1)); }
+    SIMPL_AVX2 static __m256i in(__m256i v, __m256i arg) {
+        return _mm256_xor_si256(_mm256_cmpeq_epi8(v, arg), _mm256_set1_epi8(-1));
+    }
+#endif
+};
+
+template <typename Class> char const *spanScalar(char const *p, char const *end, char arg) {
+    while (p != end && Class::in(*p, arg)) {
+        ++p;
+    }
+    return p;
+}
+
+#ifdef SIMPL_X86
+template <typename Class> char const *spanSse2(char const *p, char const *end, char arg) {
+    auto const a = _mm_set1_epi8(arg);
+    for (; end - p >= 16; p += 16) {
+        auto const v = _mm_loadu_si128(reinterpret_cast<__m128i const *>(p));
+        auto const stop = ~static_cast<uint32_t>(_mm_movemask_epi8(Class::in(v, a))) & 0xFFFF;
+        if (stop) return p + std::countr_zero(stop);
+    }
+    return spanScalar<Class>(p, end, arg);
+}
+
+template <typename Class> SIMPL_AVX2 char const *spanAvx2(char const *p, char const *end, char arg) {
+    auto const a = _mm256_set1_epi8(arg);
+    for (; end - p >= 32; p += 32) {
+        auto const v = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(p));
+        auto const stop = ~static_cast<uint32_t>(_mm256_movemask_epi8(Class::in(v, a)));
+        if (stop) return p + std::countr_zero(stop);
+    }
+    return spanSse2<Class>(p, end, arg);
+}
+#endif
+
+scan::Isa isa = scan::detectIsa();
+
+// length of the well formed utf-8 sequence at p, 0 if it is malformed or cut off by end
+ptrdiff_t sequence(char const *p, char const *end) {
+    auto const lead = static_cast<uint8_t>(*p);
+    if (lead < 0x80) return 1;
+    ptrdiff_t size{};
+    uint8_t lo = 0x80, hi = 0xBF; // bounds of the second byte, which rule out overlongs, surrogates and > U+10FFFF
+    if (lead >= 0xC2 && lead <= 0xDF) {
+        size = 2;
+    } else if (lead >= 0xE0 && lead <= 0xEF) {
+        size = 3;
+        lo = lead == 0xE0 ? 0xA0 : lo;
+        hi = lead == 0xED ? 0x9F : hi;
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+        size = 4;
+        lo = lead == 0xF0 ? 0x90 : lo;
+        hi = lead == 0xF4 ? 0x8F : hi;
+    } else {
+        return 0;
+    }
+    if (end - p < size) return 0;
+    auto const second = static_cast<uint8_t>(p[1]);
+    if (second < lo || second > hi) return 0;
+    for (ptrdiff_t i = 2; i < size; ++i) {
+        if ((static_cast<uint8_t>(p[i]) & 0xC0) != 0x80) return 0;
+    }
+    return size;
+}
+
+char const *utf8Scalar(char const *p, char const *end) {
+    while (p != end) {
+        auto const size = sequence(p, end);
+        if (size == 0) return p;
+        p += size;
+    }
+    return end;
+}
+
+#ifdef SIMPL_X86
+// without pshufb only the ascii runs are skipped in vectors
+char const *utf8Sse2(char const *p, char const *end) {
+    while (end - p >= 16) {
+        auto const high = static_cast<uint32_t>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const *>(p))));
+        if (high == 0) {
+            p += 16;
+            continue;
+        }
+        for (p += std::countr_zero(high); p != end && token::isUtf8(*p);) {
+            auto const size = sequence(p, end);
+            if (size == 0) return p;
+            p += size;
+        }
+    }
+    return utf8Scalar(p, end);
+}
+
+// the lookup algorithm of Keiser and Lemire, "Validating UTF-8 In Less Than One Instruction Per Byte"
+// three table lookups on the nibbles of each byte and of the byte before it classify every error of a pair,
+// the bytes that must continue a three or four byte sequence are checked with two more shifts
+namespace lookup {
+
+constexpr uint8_t tooShort = 1 << 0;  // 11______ 0_______ or 11______ 11______
+constexpr uint8_t tooLong = 1 << 1;   // 0_______ 10______
+constexpr uint8_t overlong3 = 1 << 2; // 11100000 100_____
+constexpr uint8_t tooLarge = 1 << 3;  // 11110100 1001____ and greater
+constexpr uint8_t surrogate = 1 << 4; // 11101101 101_____
+constexpr uint8_t overlong2 = 1 << 5; // 1100000_ 10______
+constexpr uint8_t tooLarge1000 = 1 << 6; // 11110101 1000____ and greater
+constexpr uint8_t overlong4 = 1 << 6; // 11110000 1000____
+constexpr uint8_t twoConts = 1 << 7;  // 10______ 10______
+constexpr uint8_t carry = tooShort | tooLong | twoConts;
+
+SIMPL_AVX2 __m256i table(
+    uint8_t b0, uint8_t b1, uint8_t b2, uint8_t b3, uint8_t b4, uint8_t b5, uint8_t b6, uint8_t b7, uint8_t b8,
+    uint8_t b9, uint8_t b10, uint8_t b11, uint8_t b12, uint8_t b13, uint8_t b14, uint8_t b15
+) {
+    return _mm256_setr_epi8(
+        char(b0), char(b1), char(b2), char(b3), char(b4), char(b5), char(b6), char(b7), char(b8), char(b9),
+        char(b10), char(b11), char(b12), char(b13), char(b14), char(b15), char(b0), char(b1), char(b2), char(b3),
+        char(b4), char(b5), char(b6), char(b7), char(b8), char(b9), char(b10), char(b11), char(b12), char(b13),
+        char(b14), char(b15)
+    );
+}
+
+SIMPL_AVX2 __m256i high(__m256i v) {
+    return _mm256_and_si256(_mm256_srli_epi16(v, 4), _mm256_set1_epi8(0x0F));
+}
+
+SIMPL_AVX2 __m256i low(__m256i v) {
+    return _mm256_and_si256(v, _mm256_set1_epi8(0x0F));
+}
+
+// the input shifted by n bytes, with the last bytes of the previous block shifted in
+template <int N> SIMPL_AVX2 __m256i before(__m256i input, __m256i previous) {
+    return _mm256_alignr_epi8(input, _mm256_permute2x128_si256(previous, input, 0x21), 16 - N);
+}
+
+SIMPL_AVX2 __m256i errors(__m256i input, __m256i previous) {
+    auto const prev1 = before<1>(input, previous);
+    auto const byte1High = _mm256_shuffle_epi8(
+        table(
+            tooLong, tooLong, tooLong, tooLong, tooLong, tooLong, tooLong, tooLong, twoConts, twoConts, twoConts,
+            twoConts, tooShort | overlong2, tooShort, tooShort | overlong3 | surrogate,
+            tooShort | tooLarge | tooLarge1000 | overlong4
+        ),
+        high(prev1)
+    );
+    constexpr uint8_t large = carry | tooLarge | tooLarge1000;
+    auto const byte1Low = _mm256_shuffle_epi8(
+        table(
+            carry | overlong3 | overlong2 | overlong4, carry | overlong2, carry, carry, carry | tooLarge, large, large,
+            large, large, large, large, large, large, large | surrogate, large, large
+        ),
+        low(prev1)
+    );
+    constexpr uint8_t cont = tooLong | overlong2 | twoConts;
+    auto const byte2High = _mm256_shuffle_epi8(
+        table(
+            tooShort, tooShort, tooShort, tooShort, tooShort, tooShort, tooShort, tooShort,
+            cont | overlong3 | tooLarge1000 | overlong4, cont | overlong3 | tooLarge, cont | surrogate | tooLarge,
+            cont | surrogate | tooLarge, tooShort, tooShort, tooShort, tooShort
+        ),
+        high(input)
+    );
+    auto const special = _mm256_and_si256(_mm256_and_si256(byte1High, byte1Low), byte2High);
+
+    // the third and fourth bytes of a sequence must be continuations, which shows as twoConts above
+    auto const third = _mm256_subs_epu8(before<2>(input, previous), _mm256_set1_epi8(char(0xE0 - 0x80)));
+    auto const fourth = _mm256_subs_epu8(before<3>(input, previous), _mm256_set1_epi8(char(0xF0 - 0x80)));
+    auto const must = _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8(char(0x80)));
+    return _mm256_xor_si256(must, special);
+}
+
+// set where the block ends inside a sequence
+SIMPL_AVX2 __m256i incomplete(__m256i input) {
+    auto const max = _mm256_setr_epi8(
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, char(0xF0 - 1), char(0xE0 - 1), char(0xC0 - 1)
+    );
+    return _mm256_subs_epu8(input, max);
+}
+
+} // namespace lookup
+
+SIMPL_AVX2 char const *utf8Avx2(char const *begin, char const *end) {
+    auto const *p = begin;
+    auto previous = _mm256_setzero_si256();
+    auto pending = _mm256_setzero_si256();
+    for (; end - p >= 32; p += 32) {
+        auto const input = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(p));
+        __m256i error;
+        if (_mm256_movemask_epi8(input) != 0) {
+            // a sequence the previous block ended in is checked against this one with the bytes before it
+            error = lookup::errors(input, previous);
+            pending = lookup::incomplete(input);
+        } else {
+            // ascii does not continue what the previous block ended in
+            error = pending;
+            pending = _mm256_setzero_si256();
+        }
+        if (!_mm256_testz_si256(error, error)) break;
+        previous = input;
+    }
+    // the exact position and the tail from the earliest sequence start of the last three bytes,
+    // which also catches a block that ended inside a sequence
+    auto const *from = p;
+    for (auto const *q = p; q != begin && p - q < 3;) {
+        if ((static_cast<uint8_t>(*--q) & 0xC0) != 0x80) from = q;
+    }
+    return utf8Scalar(from, end);
+}
+#endif
+
+template <typename Class> char const *span(char const *begin, char const *end, char arg = 0) {
+    // most runs are short, vectors only pay off once the run is longer than a few characters
+    for (auto const *prefix = begin + std::min<ptrdiff_t>(end - begin, 8); begin != prefix; ++begin) {
+        if (!Class::in(*begin, arg)) return begin;
+    }
+#ifdef SIMPL_X86
+    switch (isa) {
+    case scan::Isa::Avx2: return spanAvx2<Class>(begin, end, arg);
+    case scan::Isa::Sse2: return spanSse2<Class>(begin, end, arg);
+    default: break;
+    }
+#endif
+    return spanScalar<Class>(begin, end, arg);
+}
+
+} // namespace
+
+scan::Isa scan::detectIsa() {
+#if defined(SIMPL_X86) && defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 1);
+    bool const osxsave = info[2] & (1 << 27);
+    __cpuidex(info, 7, 0);
+    bool const avx2 = info[1] & (1 << 5);
+    return avx2 && osxsave && (_xgetbv(0) & 6) == 6 ? Isa::Avx2 : Isa::Sse2;
+#elif defined(SIMPL_X86)
+    __builtin_cpu_init(); // may run before the runtime initialized it
+    return __builtin_cpu_supports("avx2") ? Isa::Avx2 : Isa::Sse2;
+#else
+    return Isa::Scalar;
+#endif
+}
+
+scan::Isa scan::getIsa() {
+    return isa;
+}
+
+void scan::setIsa(Isa target) {
+    isa = std::min(target, detectIsa());
+}
+
+char const *scan::spaces(char const *begin, char const *end) {
+    return span<Spaces>(begin, end);
+}
+
+char const *scan::body(char const *begin, char const *end) {
+    return span<Body>(begin, end);
+}
+
+char const *scan::number(char const *begin, char const *end) {
+    return span<Number>(begin, end);
+}
+
+char const *scan::until(char const *begin, char const *end, char ch) {
+    return span<Until>(begin, end, ch);
+}
+
+char const *scan::utf8(char const *begin, char const *end) {
+#ifdef SIMPL_X86
+    switch (isa) {
+    case Isa::Avx2: return utf8Avx2(begin, end);
+    case Isa::Sse2: return utf8Sse2(begin, end);
+    default: break;
+    }
+#endif
+    return utf8Scalar(begin, end);
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+namespace scan {
+
+enum class Isa { Scalar, Sse2, Avx2 };
+
+Isa detectIsa();
+Isa getIsa();
+void setIsa(Isa isa); // clamped to the detected isa, which is the default
+
+// each returns the first character not in its class, or end
+char const *spaces(char const *begin, char const *end);
+char const *body(char const *begin, char const *end);
+char const *number(char const *begin, char const *end);
+char const *until(char const *begin, char const *end, char ch);
+
+// the first byte of the first malformed utf-8 sequence, or end
+char const *utf8(char const *begin, char const *end);
+
+} // namespace scan
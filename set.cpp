@@ -65,3 +65,46 @@ std::unique_ptr<Bool> Int::operator>(Int const &rhs) const {
 std::unique_ptr<Int> Int::operator-() const {
     return std::make_unique<Int>(-value());
 }
+
+std::unique_ptr<Float> Float::operator+(Float const &rhs) const {
+    return std::make_unique<Float>(value() + rhs.value());
+}
+
+std::unique_ptr<Float> Float::operator-(Float const &rhs) const {
+    return std::make_unique<Float>(value() - rhs.value());
+}
+
+std::unique_ptr<Float> Float::operator*(Float const &rhs) const {
+    return std::make_unique<Float>(value() * rhs.value());
+}
+
+std::unique_ptr<Float> Float::operator/(Float const &rhs) const {
+    return std::make_unique<Float>(value() / rhs.value());
+}
+
+std::unique_ptr<Bool> Float::operator==(Float const &rhs) const {
+    return std::make_unique<Bool>(value() == rhs.value());
+}
+
+std::unique_ptr<Bool> Float::operator!=(Float const &rhs) const {
+    return std::make_unique<Bool>(value() != rhs.value());
+}
+
+std::unique_ptr<Bool> Float::operator<(Float const &rhs) const {
+    return std::make_unique<Bool>(value() < rhs.value());
+}
+
+std::unique_ptr<Bool> Float::operator>(Float const &rhs) const {
+    return std::make_unique<Bool>(value() > rhs.value());
+}
+
+std::unique_ptr<Float> Float::operator-() const {
+    return std::make_unique<Float>(-value());
+}
+
+std::string Float::show() const {
+    auto res = std::format("{}", value());
+    // neither a dot nor an exponent, nor inf or nan
+    if (res.find_first_of(".en") == std::string::npos) res += ".0";
+    return res;
+}
@@ -1,4 +1,5 @@
 #pragma once
+#include "symbols.h"
 
 namespace set {
 
@@ -25,12 +26,14 @@ struct Interface {
     virtual bool ok() const = 0;
     virtual bool solved() const { return true; }
 
-    virtual $ extract(std::string_view name) const = 0;
+    virtual $ extract(Symbol name) const = 0;
 
     virtual $ clone() const = 0;
     virtual std::string show() const = 0;
 
     virtual $ resolve(Interface const &set) const;
+    // an operator applied to its operands in order, the result resolve would name extract
+    virtual $ apply(std::span<Interface const *const> operands) const;
 
     template <typename T> requires derived<T> T &cast() { return *static_cast<T *>(this); }
     template <typename T> requires derived<T> T const &cast() const { return *static_cast<T const *>(this); }
@@ -50,8 +53,16 @@ public:
     Set contains(Set const &set) const { return _set->contains(*set._set); }
     bool ok() const { return _set->ok(); }
     bool solved() const { return _set->solved(); }
-    Set extract(std::string_view name) const { return _set->extract(name); }
+    Set extract(Symbol name) const { return _set->extract(name); }
     Set resolve(Set const &set) const { return _set->resolve(*set._set); }
+    Set apply(Set const &v) const {
+        Interface const *const operands[]{v._set.get()};
+        return _set->apply(operands);
+    }
+    Set apply(Set const &x, Set const &y) const {
+        Interface const *const operands[]{x._set.get(), y._set.get()};
+        return _set->apply(operands);
+    }
     Set clone() const { return _set->clone(); }
     std::string show() const { return _set->show(); }
 
@@ -69,7 +80,7 @@ struct Identity : Interface {
     $ operator!=(Interface const &set) const override;
     $ contains(Interface const &set) const override { return thisset() == set.superset(); }
     bool ok() const override { return true; }
-    $ extract(std::string_view name) const override;
+    $ extract(Symbol name) const override;
     $ resolve(const Interface &set) const override;
 
     $ clone() const override;
@@ -78,7 +89,7 @@ struct Identity : Interface {
 };
 
 struct Failure : Interface {
-    constexpr static Identity const super{};
+    inline static Identity const super{};
     Failure(std::string msg = "failure") : msg(std::move(msg)) {}
     Interface const &thisset() const override { return *this; }
     Interface const &superset() const override { return super; }
@@ -87,7 +98,7 @@ struct Failure : Interface {
     $ operator!=(Interface const & /*set*/) const override { return clone(); }
     $ contains(Interface const & /*set*/) const override { return clone(); }
     bool ok() const override { return false; }
-    $ extract(std::string_view /*name*/) const override { return clone(); }
+    $ extract(Symbol /*name*/) const override { return clone(); }
 
     $ clone() const override { return std::make_unique<Failure>(msg); }
     std::string show() const override { return msg; }
@@ -107,7 +118,7 @@ public:
     bool ok() const override { return true; }
     bool solved() const override { return false; }
 
-    $ extract(std::string_view /*name*/) const override { return std::make_unique<Failure>(); }
+    $ extract(Symbol /*name*/) const override { return std::make_unique<Failure>(); }
 
     $ clone() const override { return std::make_unique<Failure>(); }
     std::string show() const override { return "unsolved" + _super->show(); }
@@ -116,7 +127,7 @@ private:
 };
 
 struct Void : Interface {
-    constexpr static Identity const id{};
+    inline static Identity const id{};
     Interface const &thisset() const override { return id; } // ref of identity
     Interface const &superset() const override;
 
@@ -124,14 +135,14 @@ struct Void : Interface {
     $ operator!=(Interface const &set) const override { return id != set; }
     $ contains(Interface const &set) const override { return id == set; }
     bool ok() const override { return true; }
-    $ extract(std::string_view /*name*/) const override { return std::make_unique<Failure>(); }
+    $ extract(Symbol /*name*/) const override { return std::make_unique<Failure>(); }
 
     $ clone() const override { return std::make_unique<Void>(); }
     std::string show() const override { return "void"; }
 };
 
 struct Universe : Interface {
-    constexpr static Identity const id{};
+    inline static Identity const id{};
     Interface const &thisset() const override { return id; }     // ref of identity
     Interface const &superset() const override { return *this; } // !
 
@@ -139,7 +150,7 @@ struct Universe : Interface {
     $ operator!=(Interface const &set) const override { return id != set; }
     $ contains(Interface const & /*set*/) const override;
     bool ok() const override { return true; }
-    $ extract(std::string_view /*name*/) const override { return std::make_unique<Failure>(); }
+    $ extract(Symbol /*name*/) const override { return std::make_unique<Failure>(); }
 
     $ clone() const override { return std::make_unique<Universe>(); }
     std::string show() const override { return "universe"; }
@@ -149,7 +160,7 @@ template <typename T> class Base : public Interface {
     constexpr static bool isBool = std::is_same_v<bool, T>;
 
 public:
-    constexpr static Identity const super{};
+    inline static Identity const super{};
 
     Base(T val) : _val(val) {}
 
@@ -169,7 +180,7 @@ public:
 
     bool ok() const override { return true; }
 
-    $ extract(std::string_view /*name*/) const override { return std::make_unique<Failure>(); }
+    $ extract(Symbol /*name*/) const override { return std::make_unique<Failure>(); }
 
     $ clone() const override { return std::make_unique<Base<T>>(_val); }
 
@@ -227,21 +238,39 @@ struct Bool final : Base<bool>, IBool {
     std::unique_ptr<Bool> boolean() const override;
 };
 
-struct Int final : Base<int>, ICalc<Int>, ICmp<Int> {
+struct Int final : Base<int64_t>, ICalc<Int>, ICmp<Int> {
     using Base::Base;
-    ICalc::Fun operator+ override;
-    ICalc::Fun operator- override;
-    ICalc::Fun operator* override;
-    ICalc::Fun operator/ override;
-    IEq::Fun operator== override;
-    IEq::Fun operator!= override;
-    IOrd::Fun operator<override;
-    IOrd::Fun operator> override;
+    std::unique_ptr<Int> operator+(Int const &rhs) const override;
+    std::unique_ptr<Int> operator-(Int const &rhs) const override;
+    std::unique_ptr<Int> operator*(Int const &rhs) const override;
+    std::unique_ptr<Int> operator/(Int const &rhs) const override;
+    std::unique_ptr<Bool> operator==(Int const &rhs) const override;
+    std::unique_ptr<Bool> operator!=(Int const &rhs) const override;
+    std::unique_ptr<Bool> operator<(Int const &rhs) const override;
+    std::unique_ptr<Bool> operator>(Int const &rhs) const override;
     using ICmp::operator<=;
     using ICmp::operator>=;
     std::unique_ptr<Int> operator-() const;
 };
 
+struct Float final : Base<double>, ICalc<Float>, ICmp<Float> {
+    using Base::Base;
+    std::unique_ptr<Float> operator+(Float const &rhs) const override;
+    std::unique_ptr<Float> operator-(Float const &rhs) const override;
+    std::unique_ptr<Float> operator*(Float const &rhs) const override;
+    std::unique_ptr<Float> operator/(Float const &rhs) const override;
+    std::unique_ptr<Bool> operator==(Float const &rhs) const override;
+    std::unique_ptr<Bool> operator!=(Float const &rhs) const override;
+    std::unique_ptr<Bool> operator<(Float const &rhs) const override;
+    std::unique_ptr<Bool> operator>(Float const &rhs) const override;
+    using ICmp::operator<=;
+    using ICmp::operator>=;
+    std::unique_ptr<Float> operator-() const;
+    $ clone() const override { return std::make_unique<Float>(value()); }
+    // keeps a fractional part, a float does not show as an int
+    std::string show() const override;
+};
+
 class Ref : public Interface {
 public:
     Ref(Interface const &set) : _set(set.thisset()) {}
@@ -252,8 +281,9 @@ public:
     $ operator!=(Interface const &set) const override { return _set != set; }
     $ contains(Interface const &set) const override { return _set.contains(set); }
     bool ok() const override { return true; }
-    $ extract(std::string_view name) const override { return _set.extract(name); }
+    $ extract(Symbol name) const override { return _set.extract(name); }
     $ resolve(const Interface &set) const override { return _set.resolve(set); }
+    $ apply(std::span<Interface const *const> operands) const override { return _set.apply(operands); }
 
     $ clone() const override { return std::make_unique<Ref>(_set.thisset()); }
     std::string show() const override { return _set.show(); }
@@ -283,9 +313,9 @@ public:
         return std::ranges::all_of(_data, [](auto const &pair) { return pair.second->ok(); });
     }
 
-    $ extract(std::string_view name) const override;
+    $ extract(Symbol name) const override;
     $ resolve(Interface const &set) const override { return (void)set, nullptr; }
-    bool add(std::string_view name, $ &&set) {
+    bool add(Symbol name, $ &&set) {
         if (!set->ok()) return true;
         auto find = _data.find(name);
         if (find != _data.end()) return false;
@@ -303,9 +333,17 @@ public:
     std::string show() const override { return "sets"; }
 
 private:
-    std::map<std::string_view, $> _data;
+    std::map<Symbol, $> _data;
 };
 
+// what resolving an operator gives, the result of applying it as its set extract
+inline $ extracting($ &&applied) {
+    if (!applied->ok() || !applied->solved()) return std::move(applied);
+    auto sets = std::make_unique<Sets>();
+    sets->add(symbol::extract, std::move(applied));
+    return sets;
+}
+
 template <typename T, auto Impl> class Unary : public Interface {
 public:
     Interface const &thisset() const override { return *this; }
@@ -315,24 +353,29 @@ public:
     $ operator!=(Interface const & /*set*/) const override { return std::make_unique<Failure>(); }
     $ contains(const Interface & /*set*/) const override { return std::make_unique<Failure>(); }
     bool ok() const override { return true; }
-    $ extract(std::string_view /*name*/) const override { return std::make_unique<Failure>(); }
+    $ extract(Symbol /*name*/) const override { return std::make_unique<Failure>(); }
 
     $ clone() const override { return std::make_unique<Ref>(*this); }
     std::string show() const override { return "module"; }
 
     $ resolve(const Interface &set) const override {
-        auto v = set.extract("v");
-        if (v->superset().resolve(Void::id)->operator!=(T::super)->template cast<Bool>().value()) {
+        auto const v = set.extract(symbol::v);
+        Interface const *const operands[]{v.get()};
+        return extracting(apply(operands));
+    }
+    $ apply(std::span<Interface const *const> operands) const override {
+        if (operands.size() != 1) {
             return std::make_unique<Failure>();
         }
-        auto val = v->resolve(Void::id);
+        auto const &v = *operands[0];
+        if (v.superset().resolve(Void::id)->operator!=(T::super)->template cast<Bool>().value()) {
+            return std::make_unique<Failure>();
+        }
+        auto val = v.resolve(Void::id);
         if (!val->ok()) {
             return std::make_unique<Unsolved>(T::super);
         }
-        auto extract = Impl(val->thisset().cast<T>());
-        auto sets = std::make_unique<Sets>();
-        sets->add("extract", std::move(extract));
-        return sets;
+        return Impl(val->thisset().cast<T>());
     }
 };
 
@@ -345,16 +388,24 @@ public:
     $ operator!=(Interface const & /*set*/) const override { return std::make_unique<Failure>(); }
     $ contains(const Interface & /*set*/) const override { return std::make_unique<Failure>(); }
     bool ok() const override { return true; }
-    $ extract(std::string_view /*name*/) const override { return std::make_unique<Failure>(); }
+    $ extract(Symbol /*name*/) const override { return std::make_unique<Failure>(); }
 
     $ clone() const override { return std::make_unique<Ref>(*this); }
     std::string show() const override { return "module"; }
 
     $ resolve(const Interface &set) const override {
-        auto x = set.extract("x");
-        auto y = set.extract("y");
-        auto superOk = []($ const &s) {
-            auto const &super = s->superset();
+        auto const x = set.extract(symbol::x);
+        auto const y = set.extract(symbol::y);
+        Interface const *const operands[]{x.get(), y.get()};
+        return extracting(apply(operands));
+    }
+    $ apply(std::span<Interface const *const> operands) const override {
+        if (operands.size() != 2) {
+            return std::make_unique<Failure>();
+        }
+        auto const &x = *operands[0], &y = *operands[1];
+        auto superOk = [](Interface const &s) {
+            auto const &super = s.superset();
             auto resolve = super.resolve(Void::id);
             auto eq = resolve->operator==(T::super);
             auto cast = eq->template cast<Bool>();
@@ -363,21 +414,48 @@ public:
         if (!superOk(x) || !superOk(y)) {
             return std::make_unique<Failure>();
         }
-        auto xx = x->resolve(Void::id);
-        auto yy = y->resolve(Void::id);
+        auto xx = x.resolve(Void::id);
+        auto yy = y.resolve(Void::id);
         if (!xx->ok() || !yy->ok()) {
             return std::make_unique<Unsolved>(T::super);
         }
-        auto extract = Impl(xx->thisset().cast<T>(), yy->thisset().cast<T>());
-        auto sets = std::make_unique<Sets>();
-        sets->add("extract", std::move(extract));
-        /*debug*/ auto rhs = xx->show();
-        /*debug*/ auto lhs = yy->show();
-        /*debug*/ auto value = sets->extract("extract")->show();
-        return sets;
+        return Impl(xx->thisset().cast<T>(), yy->thisset().cast<T>());
     }
 };
 
+// an operator of several types, applied as the first of them its operands are of
+template <typename... Ops> class Overload : public Interface {
+public:
+    Interface const &thisset() const override { return *this; }
+    Interface const &superset() const override { return Universe::id; }
+
+    $ operator==(Interface const & /*set*/) const override { return std::make_unique<Failure>(); }
+    $ operator!=(Interface const & /*set*/) const override { return std::make_unique<Failure>(); }
+    $ contains(const Interface & /*set*/) const override { return std::make_unique<Failure>(); }
+    bool ok() const override { return true; }
+    $ extract(Symbol /*name*/) const override { return std::make_unique<Failure>(); }
+
+    $ clone() const override { return std::make_unique<Ref>(*this); }
+    std::string show() const override { return "module"; }
+
+    $ resolve(const Interface &set) const override {
+        return _first([&](Interface const &op) { return op.resolve(set); });
+    }
+    $ apply(std::span<Interface const *const> operands) const override {
+        return _first([&](Interface const &op) { return op.apply(operands); });
+    }
+
+private:
+    // an op fails on operands of another type, it is unsolved on those of its own it cannot resolve yet
+    template <typename F> $ _first(F &&f) const {
+        $ res;
+        std::apply([&](auto const &...op) { (void)((res = f(op), res->ok()) || ...); }, _ops);
+        return res;
+    }
+
+    std::tuple<Ops...> _ops;
+};
+
 class Array : public Interface {
 public:
     Interface const &thisset() const override { return *this; }
@@ -404,7 +482,7 @@ public:
     void set(size_t idx, $ &&set) { _data[idx] = std::move(set); }
     void resize(size_t size) { _data.resize(size); }
 
-    $ extract(std::string_view /*name*/) const override { return nullptr; }
+    $ extract(Symbol /*name*/) const override { return nullptr; }
     $ clone() const override { return std::make_unique<Ref>(thisset()); }
     std::string show() const override { return "array"; }
 private:
@@ -412,7 +490,7 @@ private:
 };
 
 using Not = Unary<Bool, [](auto v) { return !v; }>;
-using Neg = Unary<Int, [](auto v) { return -v; }>;
+template <typename T> using Neg = Unary<T, [](auto v) { return -v; }>;
 using If = Unary<Bool, [](auto v) {
     $ s;
     if (v.value())
@@ -421,18 +499,20 @@ using If = Unary<Bool, [](auto v) {
         s = std::make_unique<Void>();
     return s;
 }>;
-using Add = Binary<Int, [](auto x, auto y) { return x + y; }>;
-using Sub = Binary<Int, [](auto x, auto y) { return x - y; }>;
-using Mul = Binary<Int, [](auto x, auto y) { return x * y; }>;
-using Div = Binary<Int, [](auto x, auto y) { return x / y; }>;
-using Lt = Binary<Int, [](auto x, auto y) { return x < y; }>;
-using Gt = Binary<Int, [](auto x, auto y) { return x > y; }>;
-using Lteq = Binary<Int, [](auto x, auto y) { return x <= y; }>;
-using Gteq = Binary<Int, [](auto x, auto y) { return x >= y; }>;
+template <typename T> using Add = Binary<T, [](auto x, auto y) { return x + y; }>;
+template <typename T> using Sub = Binary<T, [](auto x, auto y) { return x - y; }>;
+template <typename T> using Mul = Binary<T, [](auto x, auto y) { return x * y; }>;
+template <typename T> using Div = Binary<T, [](auto x, auto y) { return x / y; }>;
+template <typename T> using Lt = Binary<T, [](auto x, auto y) { return x < y; }>;
+template <typename T> using Gt = Binary<T, [](auto x, auto y) { return (x > y); }>;
+template <typename T> using Lteq = Binary<T, [](auto x, auto y) { return x <= y; }>;
+template <typename T> using Gteq = Binary<T, [](auto x, auto y) { return x >= y; }>;
 using And = Binary<Bool, [](auto x, auto y) { return x && y; }>;
 using Or = Binary<Bool, [](auto x, auto y) { return x || y; }>;
 template <typename T> using Eq = Binary<T, [](auto x, auto y) { return x.operator==(y); }>;
 template <typename T> using Noteq = Binary<T, [](auto x, auto y) { return x.operator!=(y); }>;
+// the arithmetic of the std, on two ints or on two floats
+template <template <typename> typename Op> using Numeric = Overload<Op<Int>, Op<Float>>;
 
 // // // // // //
 //  implement  //
@@ -446,6 +526,10 @@ inline $ Interface::resolve(const Interface & /*set*/) const {
     return std::make_unique<Failure>();
 }
 
+inline $ Interface::apply(std::span<Interface const *const> /*operands*/) const {
+    return std::make_unique<Failure>();
+}
+
 template <typename T> std::unique_ptr<Bool> ICmp<T>::operator<=(T const &rhs) const {
     return *(*this < rhs) || *(*this == rhs);
 }
@@ -480,7 +564,7 @@ inline $ Identity::operator==(Interface const &set) const {
     return std::make_unique<Bool>(this == &set.thisset());
 }
 
-inline $ Identity::extract(std::string_view /*name*/) const {
+inline $ Identity::extract(Symbol /*name*/) const {
     return std::make_unique<Failure>();
 }
 
@@ -503,8 +587,8 @@ inline $ Universe::contains(Interface const & /*set*/) const {
 }
 
 // Sets
-inline $ Sets::extract(std::string_view name) const {
-    if (name.empty()) {
+inline $ Sets::extract(Symbol name) const {
+    if (name == Symbol{}) {
         auto res = std::make_unique<Sets>();
         for (auto const &[k, v] : _data) {
             if (v->ok()) {
@@ -524,25 +608,28 @@ inline $ Sets::extract(std::string_view name) const {
 // std
 inline Set std() {
     auto sets = std::make_unique<Sets>();
-    sets->add("bool", Bool::super.clone());
-    sets->add("int", Int::super.clone());
-    sets->add("Add", std::make_unique<Add>());
-    sets->add("Sub", std::make_unique<Sub>());
-    sets->add("Mul", std::make_unique<Mul>());
-    sets->add("Div", std::make_unique<Div>());
-    sets->add("Not", std::make_unique<Not>());
-    sets->add("Neg", std::make_unique<Neg>());
-    sets->add("Lt", std::make_unique<Lt>());
-    sets->add("Gt", std::make_unique<Gt>());
-    sets->add("Lteq", std::make_unique<Lteq>());
-    sets->add("Gteq", std::make_unique<Gteq>());
-    sets->add("And", std::make_unique<And>());
-    sets->add("Or", std::make_unique<Or>());
-    sets->add("Eq_Int", std::make_unique<Eq<Int>>());
-    sets->add("Eq_Bool", std::make_unique<Eq<Bool>>());
-    sets->add("Noteq_Int", std::make_unique<Noteq<Int>>());
-    sets->add("Noteq_Bool", std::make_unique<Noteq<Bool>>());
-    sets->add("If", std::make_unique<If>());
+    sets->add(Symbol("bool"), Bool::super.clone());
+    sets->add(Symbol("int"), Int::super.clone());
+    sets->add(Symbol("float"), Float::super.clone());
+    sets->add(Symbol("Add"), std::make_unique<Numeric<Add>>());
+    sets->add(Symbol("Sub"), std::make_unique<Numeric<Sub>>());
+    sets->add(Symbol("Mul"), std::make_unique<Numeric<Mul>>());
+    sets->add(Symbol("Div"), std::make_unique<Numeric<Div>>());
+    sets->add(Symbol("Not"), std::make_unique<Not>());
+    sets->add(Symbol("Neg"), std::make_unique<Numeric<Neg>>());
+    sets->add(Symbol("Lt"), std::make_unique<Numeric<Lt>>());
+    sets->add(Symbol("Gt"), std::make_unique<Numeric<Gt>>());
+    sets->add(Symbol("Lteq"), std::make_unique<Numeric<Lteq>>());
+    sets->add(Symbol("Gteq"), std::make_unique<Numeric<Gteq>>());
+    sets->add(Symbol("And"), std::make_unique<And>());
+    sets->add(Symbol("Or"), std::make_unique<Or>());
+    sets->add(Symbol("Eq_Int"), std::make_unique<Eq<Int>>());
+    sets->add(Symbol("Eq_Float"), std::make_unique<Eq<Float>>());
+    sets->add(Symbol("Eq_Bool"), std::make_unique<Eq<Bool>>());
+    sets->add(Symbol("Noteq_Int"), std::make_unique<Noteq<Int>>());
+    sets->add(Symbol("Noteq_Float"), std::make_unique<Noteq<Float>>());
+    sets->add(Symbol("Noteq_Bool"), std::make_unique<Noteq<Bool>>());
+    sets->add(Symbol("If"), std::make_unique<If>());
     return {std::move(sets)};
 }
 
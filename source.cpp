@@ -0,0 +1,190 @@
+#include "source.h"
+#include "outs.h"
+#include "scan.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+Source::Source(std::string const &filename) {
+#ifdef _WIN32
+    auto file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, 0, nullptr);
+    LARGE_INTEGER size{};
+    if (file != INVALID_HANDLE_VALUE && GetFileSizeEx(file, &size)) {
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        // the zero filled tail of the last page is the sentinel, a file filling its last page has none
+        if (size.QuadPart > 0 && size.QuadPart % info.dwPageSize != 0) {
+            if (auto mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr)) {
+                _map = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                CloseHandle(mapping);
+            }
+        }
+    }
+    if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+    if (_map) {
+        _data = static_cast<char const *>(_map);
+        _size = static_cast<size_t>(size.QuadPart);
+        _ok = true;
+        return;
+    }
+#else
+    int const fd = open(filename.c_str(), O_RDONLY);
+    struct stat st {};
+    // empty or special files report no size, those are read instead
+    if (fd >= 0 && fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        auto const page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        auto const size = static_cast<size_t>(st.st_size);
+        // reserve one more page than the file needs, its zeros are the sentinel
+        _mapped = (size / page + 1) * page;
+        _map = mmap(nullptr, _mapped, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (_map != MAP_FAILED) {
+            if (mmap(_map, size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+                munmap(_map, _mapped);
+                _map = MAP_FAILED;
+            }
+        }
+        if (_map == MAP_FAILED) {
+            _map = nullptr;
+        } else {
+            _data = static_cast<char const *>(_map);
+            _size = size;
+            _ok = true;
+        }
+    }
+    if (fd >= 0) close(fd);
+    if (_map) return;
+#endif
+    _read(filename);
+}
+
+Source::~Source() {
+    if (!_map) return;
+#ifdef _WIN32
+    UnmapViewOfFile(_map);
+#else
+    munmap(_map, _mapped);
+#endif
+}
+
+void Source::_read(std::string const &filename) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file) {
+        Quiet<style::red>(), "cannot open '", filename, "'\n";
+        return;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    _fallback = std::move(buffer).str();
+    _data = _fallback.c_str();
+    _size = _fallback.size();
+    _ok = true;
+}
+
+bool replaceFile(std::string const &filename, std::string_view data) {
+    auto const tmp = std::format("{}.{}", filename, std::chrono::steady_clock::now().time_since_epoch().count());
+    std::ofstream out(tmp, std::ios::binary);
+    out << data;
+    out.close();
+    std::error_code ec;
+    if (out) {
+        std::filesystem::rename(tmp, filename, ec);
+        if (!ec) return true;
+    }
+    std::filesystem::remove(tmp, ec);
+    return false;
+}
+
+std::string_view SourceManager::load(std::string const &filename) {
+    auto &file = _files.emplace_back(File{filename, std::make_unique<Source>(filename), {0}});
+    auto const text = file.source->view();
+    auto const *const end = text.data() + text.size();
+    for (auto const *p = scan::until(text.data(), end, '\n'); p != end; p = scan::until(p + 1, end, '\n')) {
+        file.lines.push_back(static_cast<uint32_t>(p + 1 - text.data()));
+    }
+    return text;
+}
+
+SourceManager::File const *SourceManager::_find(std::string_view view) const {
+    auto const in = [view](File const &file) {
+        auto const text = file.source->view();
+        std::less_equal<char const *> const le;
+        return view.data() && le(text.data(), view.data()) && le(view.data() + view.size(), text.data() + text.size());
+    };
+    auto const it = std::ranges::find_if(_files, in);
+    return it == _files.end() ? nullptr : &*it;
+}
+
+uint32_t SourceManager::_line(File const &file, size_t offset) {
+    return static_cast<uint32_t>(std::ranges::upper_bound(file.lines, offset) - file.lines.begin());
+}
+
+std::string_view SourceManager::_text(File const &file, uint32_t line) {
+    auto const text = file.source->view();
+    auto const begin = file.lines[line - 1];
+    auto const end = line < file.lines.size() ? file.lines[line] - 1 : text.size();
+    auto res = text.substr(begin, end - begin);
+    return res.ends_with('\r') ? res.substr(0, res.size() - 1) : res;
+}
+
+namespace {
+
+// characters of utf-8 text, the continuation bytes do not count
+uint32_t width(std::string_view str) {
+    return static_cast<uint32_t>(std::ranges::count_if(str, [](char ch) { return (static_cast<uint8_t>(ch) & 0xC0) != 0x80; }));
+}
+
+} // namespace
+
+std::optional<std::pair<SourceManager::Pos, SourceManager::Pos>> SourceManager::range(std::string_view view) const {
+    auto const *file = _find(view);
+    if (!file) return {};
+    auto const text = file->source->view();
+    auto const pos = [&](size_t offset) {
+        auto const line = _line(*file, offset);
+        return Pos{line, width(text.substr(file->lines[line - 1], offset - file->lines[line - 1])) + 1};
+    };
+    auto const first = static_cast<size_t>(view.data() - text.data());
+    return std::pair{pos(first), pos(first + std::max<size_t>(view.size(), 1) - 1)};
+}
+
+void SourceManager::print(std::string_view view) const {
+    auto const *file = _find(view);
+    if (!file) {
+        Quiet(), "code out of file '", view, "'\n\n";
+        std::cout << std::flush;
+        return;
+    }
+    auto const text = file->source->view();
+    auto const first = static_cast<size_t>(view.data() - text.data());
+    auto const last = first + view.size(); // an empty view still marks where it is
+    auto const head = _line(*file, first), tail = _line(*file, std::max(last, first + 1) - 1);
+    constexpr uint32_t shown = 3; // lines at each end of a longer span
+    for (auto line = head; line <= tail; ++line) {
+        if (tail - head >= shown * 2 && line == head + shown) {
+            Quiet<style::black>(), "...\n";
+            line = tail - shown;
+            continue;
+        }
+        auto const code = _text(*file, line);
+        auto const begin = file->lines[line - 1];
+        auto const from = std::min(std::max<size_t>(first, begin) - begin, code.size()); // may sit on the line break
+        auto const to = std::max(std::min<size_t>(last, begin + code.size()) - begin, from + (line == head));
+        auto const number = "line " + std::to_string(line) + ": ";
+        Quiet<style::black>(), number;
+        Quiet(), code, '\n';
+        // tabs are kept so the marks line up with the code
+        std::string pad(number.size(), ' ');
+        for (char ch : code.substr(0, from)) {
+            if ((static_cast<uint8_t>(ch) & 0xC0) != 0x80) pad += ch == '\t' ? '\t' : ' ';
+        }
+        Quiet(), pad, std::string(std::max<uint32_t>(width(code.substr(from, to - from)), 1), '^'), '\n';
+    }
+    std::cout << std::flush;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+// a file mapped read only, followed by at least one readable '\0' so the lexer can run to the end without copying
+class Source {
+public:
+    explicit Source(std::string const &filename);
+    ~Source();
+    Source(Source const &) = delete;
+    Source &operator=(Source const &) = delete;
+
+    bool ok() const { return _ok; }
+    std::string_view view() const { return {_data, _size}; }
+
+private:
+    void _read(std::string const &filename);
+
+private:
+    char const *_data{""};
+    size_t _size{};
+    void *_map{};
+    size_t _mapped{};
+    std::string _fallback; // when the file can not be mapped with a sentinel
+    bool _ok{};
+};
+
+// writes data aside and renames it over filename, so a concurrent run never maps half of it, false if it could not
+bool replaceFile(std::string const &filename, std::string_view data);
+
+// the loaded files with the offsets of their lines, so a view finds its place by binary search
+class SourceManager {
+public:
+    struct Pos {
+        uint32_t line, column; // from 1, the column counts characters
+    };
+
+    // the text of the file, views into it stay valid as long as the manager
+    std::string_view load(std::string const &filename);
+    // the positions of the first and the last character of view, none if no loaded file holds it
+    std::optional<std::pair<Pos, Pos>> range(std::string_view view) const;
+    // every line of view, with the characters of view underlined
+    void print(std::string_view view) const;
+
+private:
+    struct File {
+        std::string name;
+        std::unique_ptr<Source> source;
+        std::vector<uint32_t> lines; // offset of the first character of every line
+    };
+
+    File const *_find(std::string_view view) const;
+    static uint32_t _line(File const &file, size_t offset);
+    static std::string_view _text(File const &file, uint32_t line);
+
+private:
+    std::vector<File> _files;
+};
@@ -0,0 +1,108 @@
+#include "symbols.h"
+#include "utils.h"
+
+namespace {
+
+constexpr uint32_t none = ~uint32_t{};
+
+} // namespace
+
+Symbols &Symbols::global() {
+    static Symbols symbols;
+    return symbols;
+}
+
+Symbols::Symbols() {
+    for (auto &shard : _shards) {
+        shard.table.store(shard.tables.emplace_back(std::make_unique<Table>(64)).get(), std::memory_order_relaxed);
+    }
+    intern(""); // id 0, what Symbol starts out as
+}
+
+Symbols::~Symbols() {
+    for (auto &segment : _segments) {
+        delete[] segment.load(std::memory_order_relaxed);
+    }
+}
+
+uint32_t Symbols::intern(std::string_view name) {
+    auto const hash = fnv1a(name);
+    auto &shard = _shards[hash >> (64 - _shardBits)];
+    if (auto const id = _find(*shard.table.load(std::memory_order_acquire), hash, name); id != none) {
+        return id;
+    }
+
+    std::lock_guard const lock(shard.lock);
+    auto *table = shard.table.load(std::memory_order_relaxed);
+    if (auto const id = _find(*table, hash, name); id != none) {
+        return id; // added by another thread meanwhile
+    }
+    // at most half full, so a probe always ends on an empty slot
+    if ((shard.used + 1) * 2 > table->mask + 1) {
+        table = &_grow(shard);
+    }
+    auto const id = _size.fetch_add(1, std::memory_order_relaxed);
+    auto const chars = shard.chars.array<char>(name.size());
+    std::ranges::copy(name, chars.begin());
+    _entry(id) = {chars.data(), chars.size()};
+    _insert(*table, hash >> 32 << 32 | (uint64_t{id} + 1)); // publishes the entry along with the slot
+    ++shard.used;
+    return id;
+}
+
+std::string_view Symbols::name(uint32_t id) const {
+    auto const [segment, offset] = _locate(id);
+    return _segments[segment].load(std::memory_order_acquire)[offset];
+}
+
+uint32_t Symbols::_find(Table const &table, uint64_t hash, std::string_view name) const {
+    auto const tag = hash >> 32;
+    for (auto i = tag & table.mask;; i = (i + 1) & table.mask) {
+        auto const slot = table.slots[i].load(std::memory_order_acquire);
+        if (slot == 0) return none;
+        auto const id = static_cast<uint32_t>(slot) - 1;
+        if (slot >> 32 == tag && this->name(id) == name) return id;
+    }
+}
+
+void Symbols::_insert(Table &table, uint64_t slot) {
+    auto i = (slot >> 32) & table.mask;
+    while (table.slots[i].load(std::memory_order_relaxed) != 0) {
+        i = (i + 1) & table.mask;
+    }
+    table.slots[i].store(slot, std::memory_order_release);
+}
+
+Symbols::Table &Symbols::_grow(Shard &shard) {
+    auto const &old = *shard.table.load(std::memory_order_relaxed);
+    auto &table = *shard.tables.emplace_back(std::make_unique<Table>((old.mask + 1) * 2));
+    for (size_t i{}; i <= old.mask; ++i) {
+        // the slot has all of the hash the table is indexed by, the names are not read again
+        if (auto const slot = old.slots[i].load(std::memory_order_relaxed); slot != 0) {
+            _insert(table, slot);
+        }
+    }
+    // lookups still probing the old table miss what is added from now on, and then take the lock
+    shard.table.store(&table, std::memory_order_release);
+    return table;
+}
+
+std::string_view &Symbols::_entry(uint32_t id) {
+    auto const [segment, offset] = _locate(id);
+    auto *entries = _segments[segment].load(std::memory_order_acquire);
+    if (!entries) {
+        std::lock_guard const lock(_segmenting);
+        entries = _segments[segment].load(std::memory_order_relaxed);
+        if (!entries) {
+            entries = new std::string_view[_firstSegment << segment];
+            _segments[segment].store(entries, std::memory_order_release);
+        }
+    }
+    return entries[offset];
+}
+
+std::pair<size_t, size_t> Symbols::_locate(uint32_t id) {
+    // segment s starts at (2^s - 1) first segments
+    auto const segment = static_cast<size_t>(std::bit_width(id / _firstSegment + 1) - 1);
+    return {segment, id - ((size_t{1} << segment) - 1) * _firstSegment};
+}
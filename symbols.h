@@ -0,0 +1,70 @@
+#pragma once
+#include "arena.h"
+
+// every name a program uses once, as a dense id, shared by all threads for the lifetime of the process
+// looking up a name that is already there takes no lock, adding one locks the shard its hash falls into
+class Symbols {
+public:
+    static Symbols &global();
+    ~Symbols();
+    Symbols(Symbols const &) = delete;
+    Symbols &operator=(Symbols const &) = delete;
+
+    uint32_t intern(std::string_view name);
+    // the name of an id intern returned, on any thread the id was handed to
+    std::string_view name(uint32_t id) const;
+    uint32_t size() const { return _size.load(std::memory_order_relaxed); }
+
+private:
+    // open addressing by the high half of the hash, which a slot holds along with the id plus one, zero while empty
+    // the shard is picked by the top bits of the hash, the tables never grow into those
+    struct Table {
+        explicit Table(size_t size) : mask(size - 1), slots(std::make_unique<std::atomic<uint64_t>[]>(size)) {}
+        size_t mask;
+        std::unique_ptr<std::atomic<uint64_t>[]> slots;
+    };
+
+    struct alignas(64) Shard {
+        std::atomic<Table *> table;
+        std::mutex lock; // adding a name, growing the table
+        std::vector<std::unique_ptr<Table>> tables; // the outgrown ones too, a lookup may still probe them
+        size_t used{};
+        Arena chars;
+    };
+
+    Symbols();
+    uint32_t _find(Table const &table, uint64_t hash, std::string_view name) const;
+    static void _insert(Table &table, uint64_t slot);
+    Table &_grow(Shard &shard);
+    // where the name of id is kept, the segment holding it is made on first use
+    std::string_view &_entry(uint32_t id);
+    static std::pair<size_t, size_t> _locate(uint32_t id);
+
+private:
+    static constexpr size_t _shardBits = 4;
+    // the names by id, in segments doubling in size from the first one, a segment never moves
+    static constexpr size_t _firstSegment = 1024;
+    std::array<Shard, size_t{1} << _shardBits> _shards;
+    std::array<std::atomic<std::string_view *>, 23> _segments{};
+    std::mutex _segmenting;
+    std::atomic<uint32_t> _size{};
+};
+
+// a name as its id in the global symbols, two of them compare as their ids do
+class Symbol {
+public:
+    Symbol() = default; // the empty name
+    explicit Symbol(std::string_view name) : _id(Symbols::global().intern(name)) {}
+
+    uint32_t id() const { return _id; }
+    std::string_view view() const { return Symbols::global().name(_id); }
+    auto operator<=>(Symbol const &) const = default;
+
+private:
+    uint32_t _id{};
+};
+
+// the names the compiler itself looks up
+namespace symbol {
+inline Symbol const x{"x"}, y{"y"}, v{"v"}, extract{"extract"};
+} // namespace symbol
@@ -0,0 +1,26 @@
+#include "tokens.h"
+
+TokenStream::TokenStream(std::string_view str, token::Dfa const &dfa, unsigned jobs) : _text(str) {
+    // a guess from the density of simpl sources, saves most reallocations
+    _kinds.reserve(str.size() / 4 + 1);
+    _spans.reserve(str.size() / 4 + 1);
+    node::Token token(Kind::Invalid, {});
+    if (jobs > 1) {
+        for (auto const &each : Lexer::lexAll(str, dfa, jobs)) {
+            _push(token = each);
+        }
+    } else {
+        Lexer lexer(str);
+        do {
+            token = lexer.next(dfa);
+            _push(token);
+        } while (token.kind != Kind::Eof);
+    }
+    _finished = Lexer::finished(token);
+}
+
+void TokenStream::_push(node::Token const &token) {
+    if (token.kind == Kind::Comment) return;
+    _kinds.push_back(token.kind.value());
+    _spans.push_back({static_cast<uint32_t>(token.view.data() - _text.data()), static_cast<uint32_t>(token.view.size())});
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include "lexer.h"
+
+// the whole input lexed up front into parallel arrays, comments dropped
+// later passes refer to a token by its 32-bit index
+class TokenStream {
+public:
+    struct Span {
+        uint32_t offset, length;
+    };
+
+    TokenStream(std::string_view str, token::Dfa const &dfa, unsigned jobs = 1);
+    // the last token is always the eof with the rest the lexer could not finish
+    uint32_t size() const { return static_cast<uint32_t>(_kinds.size()); }
+    Kind kind(uint32_t index) const { return _kinds[index]; }
+    Span span(uint32_t index) const { return _spans[index]; }
+    std::string_view view(uint32_t index) const { return _text.substr(_spans[index].offset, _spans[index].length); }
+    std::string_view text() const { return _text; }
+    // false if the input ended in the middle of a token, reported as it was lexed, see Lexer::finished
+    bool finished() const { return _finished; }
+
+private:
+    void _push(node::Token const &token);
+
+private:
+    std::string_view _text;
+    std::vector<uint16_t> _kinds;
+    std::vector<Span> _spans;
+    bool _finished{};
+};
+
+// calls comma(i) for each of the first count tokens, kind(i) being their kinds, that is a comma outside all brackets
+// such a comma only ever separates the facts of the root, so the tokens between them parse alone
+template <typename K, typename F> void topLevelCommas(size_t count, K &&kind, F &&comma) {
+    int depth{};
+    for (size_t i{}; i < count; ++i) {
+        switch (kind(i).value()) {
+        case Kind::OpenParenthesis:
+        case Kind::OpenCurlyBracket: ++depth; break;
+        case Kind::CloseParenthesis:
+        case Kind::CloseCurlyBracket: --depth; break;
+        case Kind::Comma:
+            if (depth == 0) comma(i);
+            break;
+        }
+    }
+}
@@ -7,4 +7,11 @@ inline std::string filename2module(std::string const &filename) {
 template <size_t N> struct StringLiteral {
     constexpr StringLiteral(const char (&str)[N]) { std::copy_n(str, N, value); }
     char value[N]{};
-};
\ No newline at end of file
+};
+// fnv-1a, chained through seed
+constexpr uint64_t fnv1a(std::string_view str, uint64_t seed = 0xcbf29ce484222325) {
+    for (auto c : str) {
+        seed = (seed ^ static_cast<unsigned char>(c)) * 0x100000001b3;
+    }
+    return seed;
+}